@@ -0,0 +1,22 @@
+// Arena.cpp
+#include "Arena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+    if (cursor == nullptr || padding + bytes > remaining) {
+        // Oversized requests get a chunk of their own
+        size_t size = std::max(chunk_size, bytes + alignment);
+        chunks.emplace_back(new char[size]);
+        cursor = chunks.back().get();
+        remaining = size;
+        bytes_reserved += size;
+        padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+    }
+    void* result = cursor + padding;
+    cursor += padding + bytes;
+    remaining -= padding + bytes;
+    bytes_used += bytes;
+    return result;
+}
@@ -0,0 +1,38 @@
+// Arena.hpp
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <memory_resource>
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+// Bump allocator handing out memory from large chunks. Individual
+// deallocations are ignored; everything is released when the arena dies.
+class Arena : public std::pmr::memory_resource {
+private:
+    std::vector<std::unique_ptr<char[]>> chunks;
+    size_t chunk_size;
+    char* cursor = nullptr;
+    size_t remaining = 0;
+    size_t bytes_reserved = 0;
+    size_t bytes_used = 0;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+public:
+    static const size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    explicit Arena(size_t chunk_size = DEFAULT_CHUNK_SIZE) : chunk_size(chunk_size) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    size_t bytesReserved() const { return bytes_reserved; }
+    size_t bytesUsed() const { return bytes_used; }
+    size_t chunkCount() const { return chunks.size(); }
+};
+
+#endif // ARENA_HPP
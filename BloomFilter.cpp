@@ -0,0 +1,40 @@
+// BloomFilter.cpp
+#include "BloomFilter.hpp"
+#include "Hash.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+BloomFilter::BloomFilter(size_t expected, double fpr) : capacity(std::max<size_t>(expected, 1)) {
+    // Standard sizing: m = -n ln p / (ln 2)^2, k = m/n ln 2
+    double ln2 = std::log(2.0);
+    double m = -static_cast<double>(capacity) * std::log(fpr) / (ln2 * ln2);
+    bit_count = std::max<size_t>(64, static_cast<size_t>(std::ceil(m)));
+    hash_count = std::max(1u, static_cast<unsigned>(std::round(m / capacity * ln2)));
+    bits.assign((bit_count + 63) / 64, 0);
+}
+
+void BloomFilter::add(std::string_view value) {
+    if (bits.empty()) return;
+    uint64_t h1 = std::hash<std::string_view>{}(value);
+    // Second, independent hash derived from the first (double hashing)
+    uint64_t h2 = mixHash(h1) | 1;
+    for (unsigned i = 0; i < hash_count; ++i) {
+        size_t bit = (h1 + i * h2) % bit_count;
+        bits[bit / 64] |= (1ULL << (bit % 64));
+    }
+    item_count++;
+}
+
+bool BloomFilter::mayContain(std::string_view value) const {
+    if (bits.empty()) return true;
+    uint64_t h1 = std::hash<std::string_view>{}(value);
+    uint64_t h2 = mixHash(h1) | 1;
+    for (unsigned i = 0; i < hash_count; ++i) {
+        size_t bit = (h1 + i * h2) % bit_count;
+        if (!(bits[bit / 64] & (1ULL << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,32 @@
+// BloomFilter.hpp
+#ifndef BLOOMFILTER_HPP
+#define BLOOMFILTER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+const double DEFAULT_BLOOM_FPR = 0.01;
+
+class BloomFilter {
+private:
+    std::vector<uint64_t> bits;
+    size_t bit_count = 0;
+    unsigned hash_count = 0;
+    size_t capacity = 0; // values the filter was sized for
+    size_t item_count = 0;
+
+public:
+    BloomFilter() = default;
+    BloomFilter(size_t expected, double fpr);
+
+    void add(std::string_view value);
+    bool mayContain(std::string_view value) const;
+
+    // True once more values were added than the filter was sized for
+    bool saturated() const { return item_count > capacity; }
+};
+
+#endif // BLOOMFILTER_HPP
@@ -0,0 +1,54 @@
+// Client.cpp
+#include "Client.hpp"
+#include "Protocol.hpp"
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+Client::~Client() {
+    close();
+}
+
+bool Client::connect(const std::string& socket_path, std::string* error) {
+    close();
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        if (error) *error = "Socket path is too long.";
+        return false;
+    }
+    std::strcpy(addr.sun_path, socket_path.c_str());
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        if (error) *error = std::string("Unable to connect to ") + socket_path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+    return true;
+}
+
+ClientResult Client::execute(const std::string& statement) {
+    ClientResult result;
+    std::string payload;
+    if (fd < 0) {
+        result.error = "Not connected.";
+        return result;
+    }
+    if (!writeFrame(fd, statement) || !readFrame(fd, payload) ||
+        !decodeResponse(payload, result.output, result.error)) {
+        result.error = "Connection to server lost.";
+        close();
+        return result;
+    }
+    result.delivered = true;
+    return result;
+}
+
+void Client::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
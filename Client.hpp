@@ -0,0 +1,33 @@
+// Client.hpp
+#ifndef CLIENT_HPP
+#define CLIENT_HPP
+
+#include <string>
+
+struct ClientResult {
+    bool delivered = false; // false if the connection failed; see error
+    std::string output;
+    std::string error;      // engine error text, empty on success
+
+    bool ok() const { return delivered && error.empty(); }
+};
+
+// Connection to a MiniDB server (minidb --server PATH). One statement at a
+// time; use one Client per thread.
+class Client {
+private:
+    int fd = -1;
+
+public:
+    Client() = default;
+    ~Client();
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    bool connect(const std::string& socket_path, std::string* error = nullptr);
+    bool connected() const { return fd >= 0; }
+    ClientResult execute(const std::string& statement);
+    void close();
+};
+
+#endif // CLIENT_HPP
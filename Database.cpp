@@ -1,476 +1,1636 @@
-// Database.cpp
-#include "Database.hpp"
-#include <sstream>
-#include <algorithm>
-#include <filesystem>
-#include <iostream>
-
-namespace fs = std::filesystem;
-
-void Database::createTable(const std::string& name, const std::vector<std::string>& columns) {
-    if (tables.find(name) != tables.end()) {
-        std::cerr << "Error: Table " << name << " already exists.\n";
-        return;
-    }
-    tables[name] = std::make_unique<Table>(name, columns);
-    if (!transaction_active) {
-        tables[name]->save();
-    }
-    std::cout << "Table " << name << " created successfully.\n";
-}
-
-void Database::loadTable(const std::string& name) {
-    if (tables.find(name) != tables.end()) {
-        std::cerr << "Error: Table " << name << " is already loaded.\n";
-        return;
-    }
-    // Check if file exists
-    std::string filepath = "data/" + name + ".tbl";
-    if (!fs::exists(filepath)) {
-        std::cerr << "Error: Table " << name << " does not exist.\n";
-        return;
-    }
-    tables[name] = std::make_unique<Table>(name);
-    std::cout << "Table " << name << " loaded successfully.\n";
-}
-
-void Database::autoLoadTables() {
-    std::string data_dir = "data";
-    if (fs::exists(data_dir) && fs::is_directory(data_dir)) {
-        for (const auto& entry : fs::directory_iterator(data_dir)) {
-            if (entry.is_regular_file() && entry.path().extension() == ".tbl") {
-                std::string filename = entry.path().stem().string();
-                if (tables.find(filename) == tables.end()) {
-                    tables[filename] = std::make_unique<Table>(filename);
-                    std::cout << "Loaded table: " << filename << "\n";
-                }
-            }
-        }
-    }
-}
-
-Table* Database::getTable(const std::string& name) {
-    auto it = tables.find(name);
-    if (it != tables.end()) {
-        return it->second.get();
-    }
-    std::cerr << "Error: Table " << name << " not found.\n";
-    return nullptr;
-}
-
-void Database::showTables() {
-    std::cout << "Tables:\n";
-    for (const auto& pair : tables) {
-        std::cout << "- " << pair.first << "\n";
-    }
-}
-
-void Database::showTable(const std::string& name) {
-    Table* table = getTable(name);
-    if (table) {
-        std::vector<std::string> all_columns; // Empty vector indicates all columns
-        std::vector<std::pair<std::string, std::string>> aggregates;
-        table->select(all_columns, aggregates, "", "", {}, {});
-    }
-}
-
-void Database::describeTable(const std::string& name) {
-    Table* table = getTable(name);
-    if (table) {
-        std::cout << "Table: " << name << "\n";
-        std::cout << "Columns:\n";
-        for (const auto& col : table->getColumns()) {
-            std::cout << "- " << col << "\n";
-        }
-    }
-}
-
-void Database::beginTransaction() {
-    if (transaction_active) {
-        std::cerr << "Error: Transaction already in progress.\n";
-        return;
-    }
-    // Backup current tables
-    for (auto& pair : tables) {
-        table_backups[pair.first] = std::make_unique<Table>(*pair.second);
-    }
-    transaction_active = true;
-    std::cout << "Transaction started.\n";
-}
-
-void Database::commitTransaction() {
-    if (!transaction_active) {
-        std::cerr << "Error: No active transaction to commit.\n";
-        return;
-    }
-    // Save all tables
-    for (auto& pair : tables) {
-        pair.second->save();
-    }
-    table_backups.clear();
-    transaction_active = false;
-    std::cout << "Transaction committed.\n";
-}
-
-void Database::rollbackTransaction() {
-    if (!transaction_active) {
-        std::cerr << "Error: No active transaction to rollback.\n";
-        return;
-    }
-    // Restore tables from backups
-    for (auto& pair : table_backups) {
-        if (tables.find(pair.first) != tables.end()) {
-            tables[pair.first] = std::move(pair.second);
-        }
-    }
-    table_backups.clear();
-    transaction_active = false;
-    std::cout << "Transaction rolled back.\n";
-}
-
-void Database::run() {
-    // Auto load existing tables
-    autoLoadTables();
-
-    std::string input;
-    std::cout << "Welcome to MiniDB! Enter SQL commands or 'exit' to quit.\n";
-    while (true) {
-        std::cout << "MiniDB> ";
-        std::getline(std::cin, input);
-        if (input.empty()) continue;
-
-        // Exit condition
-        if (input == "exit") break;
-
-        // Convert input to uppercase for command identification
-        std::stringstream ss(input);
-        std::string command;
-        ss >> command;
-        std::string original_command = command; // Preserve original for case-sensitive parts
-        std::transform(command.begin(), command.end(), command.begin(), ::toupper);
-
-        if (command == "CREATE") {
-            std::string table_keyword, table_name;
-            ss >> table_keyword >> table_name;
-            std::transform(table_keyword.begin(), table_keyword.end(), table_keyword.begin(), ::toupper);
-            if (table_keyword != "TABLE") {
-                std::cerr << "Error: Invalid syntax. Did you mean 'CREATE TABLE'? \n";
-                continue;
-            }
-            // Parse columns
-            size_t pos1 = input.find('(');
-            size_t pos2 = input.find(')');
-            if (pos1 == std::string::npos || pos2 == std::string::npos || pos2 <= pos1 + 1) {
-                std::cerr << "Error: Invalid syntax for CREATE TABLE.\n";
-                continue;
-            }
-            std::string cols = input.substr(pos1 + 1, pos2 - pos1 - 1);
-            std::vector<std::string> columns;
-            std::stringstream cols_ss(cols);
-            std::string col;
-            while (std::getline(cols_ss, col, ',')) {
-                // Trim whitespace
-                col.erase(col.begin(), std::find_if(col.begin(), col.end(), [](unsigned char ch) {
-                    return !std::isspace(ch);
-                }));
-                col.erase(std::find_if(col.rbegin(), col.rend(), [](unsigned char ch) {
-                    return !std::isspace(ch);
-                }).base(), col.end());
-                columns.push_back(col);
-            }
-            createTable(table_name, columns);
-        }
-        else if (command == "INSERT") {
-            std::string into_keyword, table_name, values_keyword;
-            ss >> into_keyword >> table_name >> values_keyword;
-            std::transform(into_keyword.begin(), into_keyword.end(), into_keyword.begin(), ::toupper);
-            std::transform(values_keyword.begin(), values_keyword.end(), values_keyword.begin(), ::toupper);
-            if (into_keyword != "INTO" || values_keyword != "VALUES") {
-                std::cerr << "Error: Invalid syntax. Use 'INSERT INTO table_name VALUES (...)'\n";
-                continue;
-            }
-            size_t pos1 = input.find('(');
-            size_t pos2 = input.find(')');
-            if (pos1 == std::string::npos || pos2 == std::string::npos || pos2 <= pos1 + 1) {
-                std::cerr << "Error: Invalid syntax for INSERT.\n";
-                continue;
-            }
-            std::string vals = input.substr(pos1 + 1, pos2 - pos1 - 1);
-            std::vector<std::string> values;
-            std::stringstream vals_ss(vals);
-            std::string val;
-            while (std::getline(vals_ss, val, ',')) {
-                // Trim whitespace
-                val.erase(val.begin(), std::find_if(val.begin(), val.end(), [](unsigned char ch) {
-                    return !std::isspace(ch);
-                }));
-                val.erase(std::find_if(val.rbegin(), val.rend(), [](unsigned char ch) {
-                    return !std::isspace(ch);
-                }).base(), val.end());
-                // Remove quotes if present
-                if (!val.empty() && val.front() == '\'' && val.back() == '\'') {
-                    val = val.substr(1, val.size() - 2);
-                }
-                values.push_back(val);
-            }
-            Table* table = getTable(table_name);
-            if (table) {
-                table->insert(values);
-                if (!transaction_active) {
-                    table->save();
-                }
-                std::cout << "Record inserted into " << table_name << ".\n";
-            }
-        }
-        else if (command == "SELECT") {
-            // Extract selected columns until 'FROM' is found
-            std::vector<std::string> selected_columns;
-            std::vector<std::pair<std::string, std::string>> aggregates; // aggregate function and column
-            std::string token;
-
-            while (ss >> token &&
-                   token != "FROM" &&
-                   token != "from" &&
-                   token != "From") {
-                // Handle cases where columns are separated by commas
-                if (token.back() == ',') {
-                    token.pop_back(); // Remove trailing comma
-                }
-                // Check for aggregate functions
-                size_t pos = token.find('(');
-                if (pos != std::string::npos && token.back() == ')') {
-                    std::string func = token.substr(0, pos);
-                    std::string arg = token.substr(pos + 1, token.size() - pos - 2);
-                    std::transform(func.begin(), func.end(), func.begin(), ::toupper);
-                    if (func == "COUNT") {
-                        aggregates.emplace_back("COUNT", arg);
-                    }
-                    else {
-                        std::cerr << "Error: Unsupported aggregate function '" << func << "'.\n";
-                        aggregates.clear();
-                        break;
-                    }
-                }
-                else {
-                    selected_columns.push_back(token);
-                }
-            }
-
-            // Check if 'FROM' keyword was found
-            if (!(token == "FROM" || token == "from" || token == "From")) {
-                std::cerr << "Error: Invalid syntax. Missing 'FROM'.\n";
-                continue;
-            }
-
-            // Extract table name
-            std::string table_name;
-            ss >> table_name;
-            if (table_name.empty()) {
-                std::cerr << "Error: Missing table name after 'FROM'.\n";
-                continue;
-            }
-
-            // Initialize variables for WHERE, ORDER BY, GROUP BY clauses
-            std::string clause;
-            std::string where_column, where_value;
-            std::vector<std::pair<std::string, std::string>> order_by; // column and direction
-            std::vector<std::string> group_by;
-
-            while (ss >> clause) {
-                std::string upper_clause = clause;
-                std::transform(upper_clause.begin(), upper_clause.end(), upper_clause.begin(), ::toupper);
-                if (upper_clause == "WHERE") {
-                    ss >> where_column >> where_value;
-                    // Remove potential semicolon at the end of where_value
-                    if (!where_value.empty() && where_value.back() == ';') {
-                        where_value.pop_back();
-                    }
-                    // Remove quotes if present
-                    if (!where_value.empty() && where_value.front() == '\'' && where_value.back() == '\'') {
-                        where_value = where_value.substr(1, where_value.size() - 2);
-                    }
-                }
-                else if (upper_clause == "ORDER") {
-                    std::string by;
-                    ss >> by;
-                    std::transform(by.begin(), by.end(), by.begin(), ::toupper);
-                    if (by != "BY") {
-                        std::cerr << "Error: Invalid syntax after 'ORDER'. Did you mean 'ORDER BY'? \n";
-                        break;
-                    }
-                    std::string order_col, direction = "ASC";
-                    ss >> order_col;
-                    if (!(ss >> direction)) {
-                        direction = "ASC";
-                    }
-                    else {
-                        std::transform(direction.begin(), direction.end(), direction.begin(), ::toupper);
-                        if (direction != "ASC" && direction != "DESC") {
-                            ss.unget(); // Put back the non-direction token if it's not direction
-                            direction = "ASC";
-                        }
-                    }
-                    order_by.emplace_back(order_col, direction);
-                }
-                else if (upper_clause == "GROUP") {
-                    std::string by;
-                    ss >> by;
-                    std::transform(by.begin(), by.end(), by.begin(), ::toupper);
-                    if (by != "BY") {
-                        std::cerr << "Error: Invalid syntax after 'GROUP'. Did you mean 'GROUP BY'? \n";
-                        break;
-                    }
-                    std::string group_col;
-                    ss >> group_col;
-                    group_by.emplace_back(group_col);
-                }
-                else {
-                    std::cerr << "Error: Unrecognized clause '" << clause << "'.\n";
-                    break;
-                }
-            }
-
-            // Handle '*' to select all columns
-            if (selected_columns.size() == 1 && selected_columns[0] == "*") {
-                selected_columns.clear(); // Passing an empty vector will indicate selecting all columns
-            }
-
-            // Retrieve the table and perform the select operation
-            Table* table = getTable(table_name);
-            if (table) {
-                table->select(selected_columns, aggregates, where_column, where_value, order_by, group_by);
-            }
-        }
-        else if (command == "UPDATE") {
-            std::string table_name, set_keyword;
-            ss >> table_name >> set_keyword;
-            std::transform(set_keyword.begin(), set_keyword.end(), set_keyword.begin(), ::toupper);
-            if (set_keyword != "SET") {
-                std::cerr << "Error: Invalid syntax. Did you mean 'SET'? \n";
-                continue;
-            }
-            std::string set_column, equal_sign, set_value;
-            ss >> set_column >> equal_sign >> set_value;
-            if (equal_sign != "=") {
-                std::cerr << "Error: Invalid syntax for SET. Expected '='.\n";
-                continue;
-            }
-
-            // Remove quotes if present
-            if (!set_value.empty() && set_value.front() == '\'' && set_value.back() == '\'') {
-                set_value = set_value.substr(1, set_value.size() - 2);
-            }
-
-            // Handle optional WHERE clause
-            std::string clause;
-            std::string where_column, where_value;
-            if (ss >> clause) {
-                std::string upper_clause = clause;
-                std::transform(upper_clause.begin(), upper_clause.end(), upper_clause.begin(), ::toupper);
-                if (upper_clause == "WHERE") {
-                    ss >> where_column >> where_value;
-                    // Remove potential semicolon at the end of where_value
-                    if (!where_value.empty() && where_value.back() == ';') {
-                        where_value.pop_back();
-                    }
-                    // Remove quotes if present
-                    if (!where_value.empty() && where_value.front() == '\'' && where_value.back() == '\'') {
-                        where_value = where_value.substr(1, where_value.size() - 2);
-                    }
-                }
-                else {
-                    std::cerr << "Error: Unrecognized clause '" << clause << "' in UPDATE.\n";
-                    continue;
-                }
-            }
-
-            Table* table = getTable(table_name);
-            if (table) {
-                table->update(set_column, set_value, where_column, where_value);
-                if (!transaction_active) {
-                    table->save();
-                }
-            }
-        }
-        else if (command == "DELETE") {
-            std::string from_keyword, table_name;
-            ss >> from_keyword >> table_name;
-            std::transform(from_keyword.begin(), from_keyword.end(), from_keyword.begin(), ::toupper);
-            if (from_keyword != "FROM") {
-                std::cerr << "Error: Invalid syntax. Did you mean 'DELETE FROM'? \n";
-                continue;
-            }
-
-            // Handle optional WHERE clause
-            std::string clause;
-            std::string where_column, where_value;
-            if (ss >> clause) {
-                std::string upper_clause = clause;
-                std::transform(upper_clause.begin(), upper_clause.end(), upper_clause.begin(), ::toupper);
-                if (upper_clause == "WHERE") {
-                    ss >> where_column >> where_value;
-                    // Remove potential semicolon at the end of where_value
-                    if (!where_value.empty() && where_value.back() == ';') {
-                        where_value.pop_back();
-                    }
-                    // Remove quotes if present
-                    if (!where_value.empty() && where_value.front() == '\'' && where_value.back() == '\'') {
-                        where_value = where_value.substr(1, where_value.size() - 2);
-                    }
-                }
-                else {
-                    std::cerr << "Error: Unrecognized clause '" << clause << "' in DELETE.\n";
-                    continue;
-                }
-            }
-
-            Table* table = getTable(table_name);
-            if (table) {
-                table->deleteRecords(where_column, where_value);
-                if (!transaction_active) {
-                    table->save();
-                }
-            }
-        }
-        else if (command == "SHOW") {
-            std::string target;
-            ss >> target;
-            std::transform(target.begin(), target.end(), target.begin(), ::toupper);
-            if (target == "TABLES") {
-                showTables();
-            }
-            else {
-                // Assume it's a table name
-                showTable(target);
-            }
-        }
-        else if (command == "DESCRIBE") {
-            std::string table_name;
-            ss >> table_name;
-            if (table_name.empty()) {
-                std::cerr << "Error: Missing table name for DESCRIBE.\n";
-                continue;
-            }
-            describeTable(table_name);
-        }
-        else if (command == "BEGIN") {
-            std::string transaction_keyword;
-            ss >> transaction_keyword;
-            std::transform(transaction_keyword.begin(), transaction_keyword.end(), transaction_keyword.begin(), ::toupper);
-            if (transaction_keyword != "TRANSACTION" && transaction_keyword != "TRANSACTION;") {
-                std::cerr << "Error: Invalid syntax. Use 'BEGIN TRANSACTION'.\n";
-                continue;
-            }
-            beginTransaction();
-        }
-        else if (command == "COMMIT") {
-            commitTransaction();
-        }
-        else if (command == "ROLLBACK") {
-            rollbackTransaction();
-        }
-        else {
-            std::cerr << "Error: Unrecognized command.\n";
-        }
-    }
-}
\ No newline at end of file
+// Database.cpp
+#include "Database.hpp"
+#include "Metrics.hpp"
+#include "MemoryTracker.hpp"
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <iomanip>
+#include <map>
+
+namespace fs = std::filesystem;
+
+// Whole string as a byte count
+static bool parseBytes(const std::string& value, size_t& bytes) {
+    try {
+        size_t parsed = 0;
+        bytes = std::stoull(value, &parsed);
+        return parsed == value.size();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+void Database::addTable(const std::string& name, std::unique_ptr<Table> table) {
+    tables[name] = std::move(table);
+    if (table_locks.find(name) == table_locks.end()) {
+        table_locks[name] = std::make_unique<std::shared_timed_mutex>();
+    }
+}
+
+bool Database::lockTable(Session& session, StatementLocks& locks, const std::string& name, bool exclusive,
+                         QueryContext& context) {
+    std::ostream& err = *context.err;
+    // One table at a time, so a statement never waits while holding another
+    if (locks.table_shared.owns_lock()) locks.table_shared.unlock();
+    if (locks.table_exclusive.owns_lock()) locks.table_exclusive.unlock();
+    if (session.transaction_locks.find(name) != session.transaction_locks.end()) {
+        return true; // this session's transaction already writes it
+    }
+    auto it = table_locks.find(name);
+    if (it == table_locks.end()) {
+        return true; // getTable reports the missing table
+    }
+    std::shared_timed_mutex& mutex = *it->second;
+    auto try_lock = [&] { return exclusive ? mutex.try_lock() : mutex.try_lock_shared(); };
+    if (locks.catalog_exclusive.owns_lock()) {
+        // No other statement is running, so only an open transaction can hold
+        // the table, and it cannot finish while this statement has the catalog
+        if (!try_lock()) {
+            err << "Error: Table " << name << " is locked by an open transaction.\n";
+            return false;
+        }
+    } else {
+        auto deadline = std::chrono::steady_clock::now() + TRANSACTION_LOCK_TIMEOUT;
+        while (!try_lock()) {
+            // Wait for the table with the catalog released, then try both again
+            locks.catalog_shared.unlock();
+            bool available = true;
+            if (!session.in_transaction) {
+                exclusive ? mutex.lock() : mutex.lock_shared();
+            } else {
+                available = exclusive ? mutex.try_lock_until(deadline) : mutex.try_lock_shared_until(deadline);
+            }
+            if (available) {
+                exclusive ? mutex.unlock() : mutex.unlock_shared();
+            }
+            locks.catalog_shared.lock();
+            if (!available) {
+                err << "Error: Lock wait timeout on table " << name << ": another transaction holds it.\n";
+                return false;
+            }
+        }
+    }
+    if (exclusive && session.in_transaction) {
+        std::unique_lock<std::shared_timed_mutex> lock(mutex, std::adopt_lock);
+        if (!backupTable(session, name, context)) {
+            return false;
+        }
+        session.transaction_locks[name] = std::move(lock);
+    } else if (exclusive) {
+        locks.table_exclusive = std::unique_lock<std::shared_timed_mutex>(mutex, std::adopt_lock);
+    } else {
+        locks.table_shared = std::shared_lock<std::shared_timed_mutex>(mutex, std::adopt_lock);
+    }
+    return true;
+}
+
+bool Database::backupTable(Session& session, const std::string& name, QueryContext& context) {
+    std::ostream& err = *context.err;
+    auto it = tables.find(name);
+    if (it == tables.end()) {
+        return true;
+    }
+    // The backup copies the table's rows, so check it fits before making it
+    size_t backup_bytes = it->second->backupBytes();
+    size_t session_limit = session.memory_limit;
+    if (session_limit != 0 && session.transaction_memory + backup_bytes > session_limit) {
+        err << "Error: Out of memory in transaction: backing up " << name << " needs " << backup_bytes
+            << " more bytes, over the session memory limit of " << session_limit << " bytes.\n";
+        Metrics::instance().add(Counter::MEMORY_LIMIT_ERRORS);
+        return false;
+    }
+    if (!MemoryTracker::instance().reserveTransaction(backup_bytes)) {
+        err << "Error: Out of memory in transaction: backing up " << name << " needs " << backup_bytes
+            << " more bytes, over the " << MemoryTracker::instance().describe() << ".\n";
+        Metrics::instance().add(Counter::MEMORY_LIMIT_ERRORS);
+        return false;
+    }
+    session.transaction_memory += backup_bytes;
+    session.table_backups[name] = std::make_unique<Table>(*it->second);
+    return true;
+}
+
+Table* Database::findViewTable(const std::string& view_name) {
+    for (auto& pair : tables) {
+        if (pair.second->getView(view_name)) {
+            return pair.second.get();
+        }
+    }
+    return nullptr;
+}
+
+void Database::createTable(const std::string& name, const std::vector<std::string>& columns,
+                           const std::vector<std::string>& bloom_columns, double bloom_fpr,
+                           const PartitionSpec& partitioning, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    if (name.find('#') != std::string::npos) {
+        err << "Error: Table names cannot contain '#'.\n";
+        return;
+    }
+    if (tables.find(name) != tables.end()) {
+        err << "Error: Table " << name << " already exists.\n";
+        return;
+    }
+    if (findViewTable(name)) {
+        err << "Error: A materialized view named " << name << " already exists.\n";
+        return;
+    }
+    addTable(name, std::make_unique<Table>(name, columns, partitioning));
+    if (!bloom_columns.empty() && !tables[name]->setBloomColumns(bloom_columns, bloom_fpr)) {
+        err << "Warning: Table " << name << " created without Bloom filters.\n";
+    }
+    // Creating a table is not undone by ROLLBACK; its rows are
+    tables[name]->save();
+    out << "Table " << name << " created successfully.\n";
+}
+
+void Database::loadTable(const std::string& name, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    if (tables.find(name) != tables.end()) {
+        err << "Error: Table " << name << " is already loaded.\n";
+        return;
+    }
+    // Check if file exists
+    std::string filepath = "data/" + name + ".tbl";
+    if (name.find('#') != std::string::npos || !fs::exists(filepath)) {
+        err << "Error: Table " << name << " does not exist.\n";
+        return;
+    }
+    addTable(name, std::make_unique<Table>(name));
+    out << "Table " << name << " loaded successfully.\n";
+}
+
+void Database::createView(const std::string& view_name, const std::string& table_name,
+                          const std::vector<std::string>& group_by,
+                          const std::vector<std::pair<std::string, std::string>>& aggregates,
+                          QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    if (tables.find(view_name) != tables.end() || findViewTable(view_name)) {
+        err << "Error: Table or view " << view_name << " already exists.\n";
+        return;
+    }
+    Table* table = getTable(table_name, &context);
+    if (!table || !table->createView(view_name, group_by, aggregates, &context)) {
+        return;
+    }
+    if (!context.in_transaction) {
+        table->save();
+    }
+    out << "Materialized view " << view_name << " created on " << table_name << " with "
+        << table->getView(view_name)->groupCount() << " group(s).\n";
+}
+
+void Database::dropView(const std::string& view_name, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    Table* table = findViewTable(view_name);
+    if (!table) {
+        err << "Error: Materialized view " << view_name << " not found.\n";
+        return;
+    }
+    table->dropView(view_name);
+    if (!context.in_transaction) {
+        table->save();
+    }
+    out << "Materialized view " << view_name << " dropped.\n";
+}
+
+void Database::refreshView(const std::string& view_name, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    Table* table = findViewTable(view_name);
+    if (!table) {
+        err << "Error: Materialized view " << view_name << " not found.\n";
+        return;
+    }
+    table->refreshView(view_name);
+    out << "Materialized view " << view_name << " refreshed.\n";
+}
+
+void Database::addPartition(const std::string& table_name, const std::string& partition,
+                            const std::string& upper_bound, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    Table* table = getTable(table_name, &context);
+    if (!table || !table->addPartition(partition, upper_bound, &context)) {
+        return;
+    }
+    if (!context.in_transaction) {
+        table->save();
+    }
+    out << "Partition " << partition << " added to " << table_name << ".\n";
+}
+
+void Database::dropPartition(const std::string& table_name, const std::string& partition, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    Table* table = getTable(table_name, &context);
+    if (!table || !table->dropPartition(partition, &context)) {
+        return;
+    }
+    if (!context.in_transaction) {
+        table->save();
+    }
+    out << "Partition " << partition << " dropped from " << table_name << ".\n";
+}
+
+void Database::autoLoadTables(QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::unique_lock<std::shared_mutex> lock(catalog_lock);
+    std::string data_dir = "data";
+    if (fs::exists(data_dir) && fs::is_directory(data_dir)) {
+        for (const auto& entry : fs::directory_iterator(data_dir)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".tbl") {
+                std::string filename = entry.path().stem().string();
+                // Partitions (table#partition) are loaded by their table
+                if (filename.find('#') == std::string::npos && tables.find(filename) == tables.end()) {
+                    addTable(filename, std::make_unique<Table>(filename));
+                    out << "Loaded table: " << filename << "\n";
+                }
+            }
+        }
+    }
+}
+
+Table* Database::getTable(const std::string& name, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& err = *context.err;
+    auto it = tables.find(name);
+    if (it != tables.end()) {
+        return it->second.get();
+    }
+    err << "Error: Table " << name << " not found.\n";
+    return nullptr;
+}
+
+void Database::showTables(QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    out << "Tables:\n";
+    for (const auto& pair : tables) {
+        out << "- " << pair.first << "\n";
+    }
+}
+
+void Database::showTable(const std::string& name, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    Table* table = getTable(name, &context);
+    if (table) {
+        std::vector<std::string> all_columns; // Empty vector indicates all columns
+        std::vector<std::pair<std::string, std::string>> aggregates;
+        table->select(all_columns, aggregates, "", "", {}, {}, &context);
+    }
+}
+
+void Database::describeTable(const std::string& name, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    Table* table = getTable(name, &context);
+    if (table) {
+        out << "Table: " << name << "\n";
+        out << "Columns:\n";
+        for (const auto& col : table->getColumns()) {
+            out << "- " << col;
+            if (table->hasBloom(col)) out << " (bloom)";
+            std::string encoding = table->getEncoding(col);
+            if (encoding != "PLAIN") out << " [" << encoding << "]";
+            out << "\n";
+        }
+        if (table->deletedCount() > 0) {
+            out << "Deleted rows awaiting VACUUM: " << table->deletedCount() << "\n";
+        }
+        const PartitionSpec& spec = table->getPartitionSpec();
+        if (spec.isPartitioned()) {
+            out << "Partitioned by " << spec.methodName() << "(" << table->getColumns()[spec.getColumn()] << "):\n";
+            std::vector<const Table*> partitions = table->getPartitions();
+            for (size_t i = 0; i < partitions.size(); ++i) {
+                out << "- " << spec.name(i) << ": " << spec.describe(i) << " (" << partitions[i]->rowCount() << " rows)\n";
+            }
+        }
+        if (!table->getViews().empty()) {
+            out << "Materialized views:\n";
+            for (const auto& view : table->getViews()) {
+                out << "- " << view.getName() << ": " << view.definition(name, table->getColumns())
+                    << " (" << view.groupCount() << " groups)\n";
+            }
+        }
+        const TableStats& stats = table->getStats();
+        if (stats.isAnalyzed()) {
+            out << "Statistics (" << stats.rowCount() << " rows):\n";
+            const char* headers[] = {"Column", "Null fraction", "Distinct (est.)", "Buckets"};
+            for (size_t i = 0; i < 4; ++i) {
+                out << std::left << std::setw(15) << headers[i];
+                if (i != 3) out << " | ";
+            }
+            out << "\n";
+            for (size_t i = 0; i < 4; ++i) {
+                out << "---------------";
+                if (i != 3) out << "+";
+            }
+            out << "\n";
+            const auto& columns = table->getColumns();
+            for (size_t i = 0; i < columns.size(); ++i) {
+                std::stringstream fraction;
+                fraction << std::fixed << std::setprecision(3) << stats.nullFraction(i);
+                out << std::left << std::setw(15) << columns[i] << " | "
+                    << std::setw(15) << fraction.str() << " | "
+                    << std::setw(15) << stats.distinctEstimate(i) << " | "
+                    << std::setw(15) << stats.column(i).bounds.size() << "\n";
+            }
+        }
+    }
+}
+
+void Database::showMemory(QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    const char* headers[] = {"Table", "Rows", "Distinct values", "Value bytes", "Row bytes", "Total bytes"};
+    for (size_t i = 0; i < 6; ++i) {
+        out << std::left << std::setw(15) << headers[i];
+        if (i != 5) out << " | ";
+    }
+    out << "\n";
+    for (size_t i = 0; i < 6; ++i) {
+        out << "---------------";
+        if (i != 5) out << "+";
+    }
+    out << "\n";
+    size_t total = 0;
+    auto print_row = [&](const std::string& label, const Table& table) {
+        size_t value_bytes = table.getPool().bytesReserved();
+        size_t row_bytes = table.getRowArena().bytesReserved() + table.recordBytes();
+        total += value_bytes + row_bytes;
+        out << std::left << std::setw(15) << label << " | "
+                  << std::setw(15) << table.rowCount() << " | "
+                  << std::setw(15) << table.getPool().distinctCount() << " | "
+                  << std::setw(15) << value_bytes << " | "
+                  << std::setw(15) << row_bytes << " | "
+                  << std::setw(15) << value_bytes + row_bytes << "\n";
+    };
+    for (const auto& pair : tables) {
+        if (!pair.second->getPartitionSpec().isPartitioned()) {
+            print_row(pair.first, *pair.second);
+            continue;
+        }
+        // Rows live in the partitions, one line each
+        for (const Table* partition : pair.second->getPartitions()) {
+            print_row(partition->getName(), *partition);
+        }
+    }
+    out << "Total: " << total << " bytes\n";
+    const MemoryTracker& tracker = MemoryTracker::instance();
+    out << "Transaction backups: " << tracker.transactionBytes() << " bytes\n";
+    out << "Memory limits: global " << tracker.getLimit() << ", session " << context.memory.getLimit()
+        << " bytes (0 = none)\n";
+}
+
+void Database::showStats(QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    MetricsSnapshot snap = Metrics::instance().snapshot();
+    const char* counter_names[COUNTER_COUNT] = {
+        "SELECT statements", "INSERT statements", "UPDATE statements", "DELETE statements",
+        "Other statements", "Rows scanned", "Rows returned", "Rows inserted", "Rows updated",
+        "Rows deleted", "Rows vacuumed", "Blocks scanned", "Blocks skipped", "Saves", "Save bytes",
+        "Loads", "Transactions begun", "Transactions committed", "Transactions rolled back",
+        "Cache hits", "Cache misses", "Cache invalidations", "Cache evictions", "Memory limit errors"};
+    out << std::left << std::setw(25) << "Counter" << " | " << "Value" << "\n";
+    out << "-------------------------+---------------\n";
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        out << std::left << std::setw(25) << counter_names[i] << " | " << snap.counters[i] << "\n";
+    }
+    out << "\nResult cache: " << (result_cache_enabled ? "ON" : "OFF") << ", " << result_cache.entryCount()
+        << " entries, " << result_cache.bytesUsed() << " of " << result_cache.capacity() << " bytes\n";
+    const MemoryTracker& tracker = MemoryTracker::instance();
+    out << "Memory: " << tracker.tableBytes() << " bytes in tables, " << tracker.transactionBytes()
+        << " in transaction backups, " << tracker.queryBytes() << " in running queries; global limit "
+        << tracker.getLimit() << " (0 = none)\n\n";
+
+    const char* latency_names[LATENCY_COUNT] = {"Statement", "Save", "Load"};
+    const char* headers[] = {"Latency (us)", "Count", "Mean", "p50", "p99", "Max"};
+    for (size_t i = 0; i < 6; ++i) {
+        out << std::left << std::setw(15) << headers[i];
+        if (i != 5) out << " | ";
+    }
+    out << "\n";
+    for (size_t i = 0; i < 6; ++i) {
+        out << "---------------";
+        if (i != 5) out << "+";
+    }
+    out << "\n";
+    for (size_t i = 0; i < LATENCY_COUNT; ++i) {
+        const Histogram& h = snap.latencies[i];
+        out << std::left << std::setw(15) << latency_names[i] << " | "
+                  << std::setw(15) << h.count() << " | "
+                  << std::setw(15) << std::fixed << std::setprecision(1) << h.mean() / 1000.0 << " | "
+                  << std::setw(15) << h.percentile(0.50) / 1000.0 << " | "
+                  << std::setw(15) << h.percentile(0.99) / 1000.0 << " | "
+                  << std::setw(15) << h.max() / 1000.0 << "\n";
+    }
+    out << std::defaultfloat << std::setprecision(6);
+}
+
+void Database::setOption(const std::string& name, const std::string& value, Session& session, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    std::string option = name, setting = value;
+    std::transform(option.begin(), option.end(), option.begin(), ::tolower);
+    std::transform(setting.begin(), setting.end(), setting.begin(), ::toupper);
+    if (option == "result_cache") {
+        if (setting != "ON" && setting != "OFF") {
+            err << "Error: result_cache must be ON or OFF.\n";
+            return;
+        }
+        result_cache_enabled = setting == "ON";
+        if (!result_cache_enabled) {
+            result_cache.clear();
+        }
+        out << "result_cache = " << setting << "\n";
+    }
+    else if (option == "result_cache_size") {
+        size_t bytes = 0;
+        if (!parseBytes(value, bytes) || bytes == 0) {
+            err << "Error: result_cache_size must be a positive number of bytes.\n";
+            return;
+        }
+        result_cache.setCapacity(bytes);
+        out << "result_cache_size = " << bytes << "\n";
+    }
+    else if (option == "memory_limit" || option == "global_memory_limit") {
+        size_t bytes = 0;
+        if (setting != "OFF" && !parseBytes(value, bytes)) {
+            err << "Error: " << option << " must be a number of bytes, or 0 or OFF for none.\n";
+            return;
+        }
+        if (option == "memory_limit") {
+            session.memory_limit = bytes;
+        } else {
+            MemoryTracker::instance().setLimit(bytes);
+        }
+        out << option << " = " << bytes << "\n";
+    }
+    else {
+        err << "Error: Unknown setting '" << name << "'.\n";
+    }
+}
+
+bool Database::publishTableMetrics(Session* session, bool wait) {
+    std::shared_lock<std::shared_mutex> catalog(catalog_lock, std::defer_lock);
+    if (wait) {
+        catalog.lock();
+    } else if (!catalog.try_lock()) {
+        return false;
+    }
+    std::map<std::string, TableGauges> gauges, previous;
+    bool have_previous = false;
+    size_t table_bytes = 0;
+    for (const auto& pair : tables) {
+        // Never wait for a table (an open transaction may keep it for long);
+        // the session's own transaction tables are already held
+        bool held = session && session->transaction_locks.find(pair.first) != session->transaction_locks.end();
+        std::shared_lock<std::shared_timed_mutex> table_lock(*table_locks.at(pair.first), std::defer_lock);
+        if (!held && !table_lock.try_lock()) {
+            if (!have_previous) {
+                previous = Metrics::instance().snapshot().tables;
+                have_previous = true;
+            }
+            auto last = previous.find(pair.first);
+            if (last != previous.end()) {
+                gauges[pair.first] = last->second;
+                table_bytes += last->second.memory_bytes;
+            }
+            continue;
+        }
+        const Table& table = *pair.second;
+        TableGauges& g = gauges[pair.first];
+        g.rows = table.rowCount();
+        g.deleted_rows = table.deletedCount();
+        g.memory_bytes = table.memoryBytes();
+        table_bytes += g.memory_bytes;
+    }
+    Metrics::instance().setTableGauges(gauges);
+    MemoryTracker::instance().setTableBytes(table_bytes);
+    return true;
+}
+
+void Database::printQueryStats(const QueryStats& stats, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    out << "Blocks scanned: " << stats.blocks_scanned
+              << ", skipped: " << stats.blocks_skipped;
+    if (stats.bloom_skipped > 0) {
+        out << " (" << stats.bloom_skipped << " by Bloom filter)";
+    }
+    if (stats.partitions_scanned + stats.partitions_pruned > 0) {
+        out << ", partitions scanned: " << stats.partitions_scanned << ", pruned: " << stats.partitions_pruned;
+    }
+    out << "\n";
+}
+
+void Database::printProfile(const QueryStats& stats, StageClock::time_point statement_start, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    double total_ms = std::chrono::duration<double, std::milli>(StageClock::now() - statement_start).count();
+    const char* headers[] = {"Stage", "Time (ms)", "Rows in", "Rows out", "Bytes", "I/O bytes"};
+    for (size_t i = 0; i < 6; ++i) {
+        out << std::left << std::setw(15) << headers[i];
+        if (i != 5) out << " | ";
+    }
+    out << "\n";
+    for (size_t i = 0; i < 6; ++i) {
+        out << "---------------";
+        if (i != 5) out << "+";
+    }
+    out << "\n";
+    size_t bytes = 0, io_bytes = 0;
+    for (const auto& stage : stats.stages) {
+        bytes += stage.bytes_allocated;
+        io_bytes += stage.io_bytes;
+        out << std::left << std::setw(15) << stage.name << " | "
+                  << std::setw(15) << std::fixed << std::setprecision(3) << stage.ms << " | "
+                  << std::setw(15) << stage.rows_in << " | "
+                  << std::setw(15) << stage.rows_out << " | "
+                  << std::setw(15) << stage.bytes_allocated << " | "
+                  << std::setw(15) << stage.io_bytes << "\n";
+    }
+    out << "Total: " << total_ms << " ms, " << bytes << " bytes allocated, "
+              << io_bytes << " bytes of I/O\n";
+    out << "Peak memory: " << context.memory.peakBytes() << " bytes reserved";
+    if (context.memory.getLimit() != 0) {
+        out << " of " << context.memory.getLimit() << " allowed";
+    }
+    out << "\n";
+    out << std::defaultfloat << std::setprecision(6);
+}
+
+void Database::beginTransaction(Session& session, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    if (session.in_transaction) {
+        err << "Error: Transaction already in progress.\n";
+        return;
+    }
+    // Nothing is locked or copied yet: each table is backed up on its first write
+    session.in_transaction = true;
+    Metrics::instance().add(Counter::TXN_BEGIN);
+    out << "Transaction started.\n";
+}
+
+void Database::commitTransaction(Session& session, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    if (!session.in_transaction) {
+        err << "Error: No active transaction to commit.\n";
+        return;
+    }
+    // Backups go first, so saving can reclaim values they shared
+    session.table_backups.clear();
+    for (const auto& pair : session.transaction_locks) {
+        auto it = tables.find(pair.first);
+        if (it != tables.end()) {
+            it->second->save();
+        }
+    }
+    session.transaction_locks.clear();
+    MemoryTracker::instance().releaseTransaction(session.transaction_memory);
+    session.transaction_memory = 0;
+    session.in_transaction = false;
+    Metrics::instance().add(Counter::TXN_COMMIT);
+    out << "Transaction committed.\n";
+}
+
+void Database::rollbackTransaction(Session& session, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    if (!session.in_transaction) {
+        err << "Error: No active transaction to rollback.\n";
+        return;
+    }
+    // Restore tables from backups, before their locks are released
+    for (auto& pair : session.table_backups) {
+        auto it = tables.find(pair.first);
+        if (it != tables.end()) {
+            it->second = std::move(pair.second);
+            it->second->recountPool();
+        }
+    }
+    session.table_backups.clear();
+    session.transaction_locks.clear();
+    MemoryTracker::instance().releaseTransaction(session.transaction_memory);
+    session.transaction_memory = 0;
+    session.in_transaction = false;
+    Metrics::instance().add(Counter::TXN_ROLLBACK);
+    out << "Transaction rolled back.\n";
+}
+
+void Database::run() {
+    Session session;
+    // Auto load existing tables
+    autoLoadTables();
+
+    std::string input;
+    std::cout << "Welcome to MiniDB! Enter SQL commands or 'exit' to quit.\n";
+    while (true) {
+        publishTableMetrics(&session);
+        std::cout << "MiniDB> ";
+        if (!std::getline(std::cin, input)) break;
+        if (input.empty()) continue;
+
+        // Exit condition
+        if (input == "exit") break;
+        execute(input, session);
+    }
+    endSession(session);
+}
+
+void Database::endSession(Session& session) {
+    if (session.in_transaction) {
+        QueryContext context(*session.out, *session.err);
+        std::unique_lock<std::shared_mutex> catalog(catalog_lock);
+        rollbackTransaction(session, &context);
+    }
+}
+
+void Database::execute(const std::string& input, Session& session) {
+    QueryContext context(*session.out, *session.err);
+    context.memory.setLimit(session.memory_limit);
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    auto statement_start = StageClock::now();
+    ScopedLatency statement_latency(Latency::STATEMENT);
+
+    // Convert input to uppercase for command identification
+    std::stringstream ss(input);
+    std::string command;
+    ss >> command;
+    std::string original_command = command; // Preserve original for case-sensitive parts
+    std::transform(command.begin(), command.end(), command.begin(), ::toupper);
+
+    // EXPLAIN [ANALYZE] <statement>: parse the statement as usual, then plan or profile it
+    bool explain = false, analyze = false;
+    if (command == "EXPLAIN") {
+        explain = true;
+        std::string rest;
+        std::getline(ss, rest);
+        ss.str(rest);
+        ss.clear();
+        ss >> command;
+        std::transform(command.begin(), command.end(), command.begin(), ::toupper);
+        if (command == "ANALYZE") {
+            analyze = true;
+            ss >> command;
+            std::transform(command.begin(), command.end(), command.begin(), ::toupper);
+        }
+        if (command != "SELECT" && command != "UPDATE" && command != "DELETE") {
+            err << "Error: EXPLAIN supports SELECT, UPDATE and DELETE.\n";
+            return;
+        }
+    }
+    Metrics::instance().add(command == "SELECT" ? Counter::STATEMENTS_SELECT
+                            : command == "INSERT" ? Counter::STATEMENTS_INSERT
+                            : command == "UPDATE" ? Counter::STATEMENTS_UPDATE
+                            : command == "DELETE" ? Counter::STATEMENTS_DELETE
+                            : Counter::STATEMENTS_OTHER);
+
+    // Take the catalog exclusively for statements that add tables or views or read all
+    // of them, and for ROLLBACK, which replaces tables; shared otherwise
+    std::string show_target, keyword;
+    if (command == "SHOW") {
+        std::stringstream target_ss(input);
+        target_ss >> keyword >> show_target;
+        std::transform(show_target.begin(), show_target.end(), show_target.begin(), ::toupper);
+    }
+    StatementLocks locks;
+    if (command == "CREATE" || command == "DROP" || command == "REFRESH" || command == "ROLLBACK" ||
+        (command == "SHOW" && show_target == "MEMORY")) {
+        locks.catalog_exclusive = std::unique_lock<std::shared_mutex>(catalog_lock);
+    } else {
+        locks.catalog_shared = std::shared_lock<std::shared_mutex>(catalog_lock);
+    }
+    context.in_transaction = session.in_transaction;
+
+    if (command == "CREATE") {
+        std::string table_keyword, table_name;
+        ss >> table_keyword >> table_name;
+        std::transform(table_keyword.begin(), table_keyword.end(), table_keyword.begin(), ::toupper);
+        if (table_keyword == "MATERIALIZED") {
+            // CREATE MATERIALIZED VIEW name AS SELECT cols, AGG(col), ... FROM table [GROUP BY col, ...]
+            std::string view_keyword = table_name, view_name, as_keyword, select_keyword;
+            ss >> view_name >> as_keyword >> select_keyword;
+            std::transform(view_keyword.begin(), view_keyword.end(), view_keyword.begin(), ::toupper);
+            std::transform(as_keyword.begin(), as_keyword.end(), as_keyword.begin(), ::toupper);
+            std::transform(select_keyword.begin(), select_keyword.end(), select_keyword.begin(), ::toupper);
+            if (view_keyword != "VIEW" || view_name.empty() || as_keyword != "AS" || select_keyword != "SELECT") {
+                err << "Error: Invalid syntax. Use 'CREATE MATERIALIZED VIEW name AS SELECT ... FROM table GROUP BY ...'.\n";
+                return;
+            }
+            std::string token, select_list, source_table;
+            while (ss >> token) {
+                std::string upper_token = token;
+                std::transform(upper_token.begin(), upper_token.end(), upper_token.begin(), ::toupper);
+                if (upper_token == "FROM") break;
+                select_list += token + " ";
+            }
+            ss >> source_table;
+            std::vector<std::string> group_by;
+            std::string group_keyword, by_keyword, group_list;
+            if (ss >> group_keyword) {
+                ss >> by_keyword;
+                std::transform(group_keyword.begin(), group_keyword.end(), group_keyword.begin(), ::toupper);
+                std::transform(by_keyword.begin(), by_keyword.end(), by_keyword.begin(), ::toupper);
+                if (group_keyword != "GROUP" || by_keyword != "BY") {
+                    err << "Error: Unrecognized clause '" << group_keyword << "' in CREATE MATERIALIZED VIEW.\n";
+                    return;
+                }
+                std::getline(ss, group_list);
+            }
+            auto split = [](const std::string& list) {
+                std::vector<std::string> items;
+                std::stringstream list_ss(list);
+                std::string item;
+                while (std::getline(list_ss, item, ',')) {
+                    item.erase(item.begin(), std::find_if(item.begin(), item.end(), [](unsigned char ch) {
+                        return !std::isspace(ch);
+                    }));
+                    item.erase(std::find_if(item.rbegin(), item.rend(), [](unsigned char ch) {
+                        return !std::isspace(ch) && ch != ';';
+                    }).base(), item.end());
+                    if (!item.empty()) items.push_back(item);
+                }
+                return items;
+            };
+            group_by = split(group_list);
+            if (!source_table.empty() && source_table.back() == ';') {
+                source_table.pop_back();
+            }
+            if (source_table.empty()) {
+                err << "Error: Missing table name after 'FROM'.\n";
+                return;
+            }
+            std::vector<std::pair<std::string, std::string>> aggregates;
+            for (const auto& item : split(select_list)) {
+                size_t pos = item.find('(');
+                if (pos != std::string::npos && item.back() == ')') {
+                    std::string func = item.substr(0, pos);
+                    std::string arg = item.substr(pos + 1, item.size() - pos - 2);
+                    std::transform(func.begin(), func.end(), func.begin(), ::toupper);
+                    if (func != "COUNT" && func != "SUM" && func != "MIN" && func != "MAX") {
+                        err << "Error: Unsupported aggregate function '" << func << "' in a materialized view.\n";
+                        return;
+                    }
+                    if (arg == "*" && func != "COUNT") {
+                        err << "Error: " << func << "(*) is not supported.\n";
+                        return;
+                    }
+                    aggregates.emplace_back(func, arg);
+                }
+                else if (std::find(group_by.begin(), group_by.end(), item) == group_by.end()) {
+                    err << "Error: Column " << item << " must appear in GROUP BY.\n";
+                    return;
+                }
+            }
+            if (aggregates.empty()) {
+                err << "Error: A materialized view needs at least one aggregate.\n";
+                return;
+            }
+            if (!lockTable(session, locks, source_table, true, context)) {
+                return;
+            }
+            createView(view_name, source_table, group_by, aggregates, &context);
+            return;
+        }
+        if (table_keyword != "TABLE") {
+            err << "Error: Invalid syntax. Did you mean 'CREATE TABLE'? \n";
+            return;
+        }
+        // Parse columns
+        size_t pos1 = input.find('(');
+        size_t pos2 = input.find(')');
+        if (pos1 == std::string::npos || pos2 == std::string::npos || pos2 <= pos1 + 1) {
+            err << "Error: Invalid syntax for CREATE TABLE.\n";
+            return;
+        }
+        std::string cols = input.substr(pos1 + 1, pos2 - pos1 - 1);
+        std::vector<std::string> columns;
+        std::stringstream cols_ss(cols);
+        std::string col;
+        while (std::getline(cols_ss, col, ',')) {
+            // Trim whitespace
+            col.erase(col.begin(), std::find_if(col.begin(), col.end(), [](unsigned char ch) {
+                return !std::isspace(ch);
+            }));
+            col.erase(std::find_if(col.rbegin(), col.rend(), [](unsigned char ch) {
+                return !std::isspace(ch);
+            }).base(), col.end());
+            columns.push_back(col);
+        }
+
+        auto trim = [](std::string text) {
+            text.erase(text.begin(), std::find_if(text.begin(), text.end(), [](unsigned char ch) {
+                return !std::isspace(ch);
+            }));
+            text.erase(std::find_if(text.rbegin(), text.rend(), [](unsigned char ch) {
+                return !std::isspace(ch) && ch != ';';
+            }).base(), text.end());
+            return text;
+        };
+        std::string options = input.substr(pos2 + 1);
+        std::string upper_options = options;
+        std::transform(upper_options.begin(), upper_options.end(), upper_options.begin(), ::toupper);
+
+        // Optional PARTITION BY RANGE(col) (p VALUES LESS THAN (bound|MAXVALUE), ...)
+        //       or PARTITION BY HASH(col) PARTITIONS n, before or after BLOOM
+        PartitionSpec partitioning;
+        size_t partition_pos = upper_options.find("PARTITION BY");
+        if (partition_pos != std::string::npos) {
+            size_t clause_end = upper_options.find("BLOOM", partition_pos);
+            if (clause_end == std::string::npos) clause_end = upper_options.size();
+            std::string clause = options.substr(partition_pos + 12, clause_end - partition_pos - 12);
+            std::string upper_clause = upper_options.substr(partition_pos + 12, clause_end - partition_pos - 12);
+            options.erase(partition_pos, clause_end - partition_pos);
+            upper_options.erase(partition_pos, clause_end - partition_pos);
+            size_t open = clause.find('('), close = clause.find(')');
+            std::string method = open == std::string::npos ? "" : trim(upper_clause.substr(0, open));
+            if ((method != "RANGE" && method != "HASH") || close == std::string::npos || close <= open + 1) {
+                err << "Error: Invalid syntax for PARTITION BY. Use 'PARTITION BY RANGE(column) (...)' "
+                    << "or 'PARTITION BY HASH(column) PARTITIONS n'.\n";
+                return;
+            }
+            std::string partition_column = trim(clause.substr(open + 1, close - open - 1));
+            auto it = std::find(columns.begin(), columns.end(), partition_column);
+            if (it == columns.end()) {
+                err << "Error: Partition column " << partition_column << " does not exist.\n";
+                return;
+            }
+            int partition_idx = std::distance(columns.begin(), it);
+            std::string rest = clause.substr(close + 1);
+            if (method == "HASH") {
+                std::stringstream rest_ss(rest);
+                std::string partitions_keyword;
+                long count = 0;
+                rest_ss >> partitions_keyword >> count;
+                std::transform(partitions_keyword.begin(), partitions_keyword.end(), partitions_keyword.begin(), ::toupper);
+                if (partitions_keyword != "PARTITIONS" || count < 1 || count > 1024) {
+                    err << "Error: HASH partitioning needs 'PARTITIONS n' with n between 1 and 1024.\n";
+                    return;
+                }
+                partitioning = PartitionSpec::hash(partition_idx, count);
+            } else {
+                size_t list_open = rest.find('('), list_close = rest.rfind(')');
+                if (list_open == std::string::npos || list_close == std::string::npos || list_close <= list_open) {
+                    err << "Error: RANGE partitioning needs a list '(p VALUES LESS THAN (bound), ...)'.\n";
+                    return;
+                }
+                // Split on commas outside the bounds' parentheses
+                std::vector<std::string> definitions;
+                std::string definition;
+                int depth = 0;
+                for (char c : rest.substr(list_open + 1, list_close - list_open - 1)) {
+                    if (c == '(') depth++;
+                    if (c == ')') depth--;
+                    if (c == ',' && depth == 0) {
+                        definitions.push_back(definition);
+                        definition.clear();
+                    } else {
+                        definition += c;
+                    }
+                }
+                definitions.push_back(definition);
+                partitioning = PartitionSpec::range(partition_idx, {}, {});
+                for (const auto& item : definitions) {
+                    std::stringstream item_ss(item);
+                    std::string partition_name, values_keyword, less_keyword, than_keyword;
+                    item_ss >> partition_name >> values_keyword >> less_keyword >> than_keyword;
+                    std::string bound;
+                    std::getline(item_ss, bound);
+                    bound = trim(bound);
+                    std::string upper_bound = bound;
+                    std::transform(upper_bound.begin(), upper_bound.end(), upper_bound.begin(), ::toupper);
+                    std::string keywords = values_keyword + " " + less_keyword + " " + than_keyword;
+                    std::transform(keywords.begin(), keywords.end(), keywords.begin(), ::toupper);
+                    if (partition_name.empty() || keywords != "VALUES LESS THAN" || bound.empty()) {
+                        err << "Error: Invalid partition definition '" << trim(item)
+                            << "'. Use 'name VALUES LESS THAN (bound)' or 'name VALUES LESS THAN MAXVALUE'.\n";
+                        return;
+                    }
+                    if (upper_bound == "MAXVALUE") {
+                        bound.clear();
+                    } else {
+                        if (bound.front() == '(' && bound.back() == ')') bound = trim(bound.substr(1, bound.size() - 2));
+                        if (bound.size() >= 2 && bound.front() == '\'' && bound.back() == '\'') {
+                            bound = bound.substr(1, bound.size() - 2);
+                        }
+                    }
+                    std::string error;
+                    if (!partitioning.addRange(partition_name, bound, error)) {
+                        err << "Error: " << error << ".\n";
+                        return;
+                    }
+                }
+            }
+        }
+
+        // Optional BLOOM(col, ...) [FPR rate] after the column list
+        std::vector<std::string> bloom_columns;
+        double bloom_fpr = DEFAULT_BLOOM_FPR;
+        size_t bloom_pos = upper_options.find("BLOOM");
+        size_t options_end = 0;
+        if (bloom_pos != std::string::npos) {
+            size_t open = options.find('(', bloom_pos);
+            size_t close = options.find(')', bloom_pos);
+            if (open == std::string::npos || close == std::string::npos || close <= open + 1) {
+                err << "Error: Invalid syntax for BLOOM. Use 'BLOOM(column, ...)'.\n";
+                return;
+            }
+            options_end = close + 1;
+            std::stringstream bloom_ss(options.substr(open + 1, close - open - 1));
+            while (std::getline(bloom_ss, col, ',')) {
+                col.erase(col.begin(), std::find_if(col.begin(), col.end(), [](unsigned char ch) {
+                    return !std::isspace(ch);
+                }));
+                col.erase(std::find_if(col.rbegin(), col.rend(), [](unsigned char ch) {
+                    return !std::isspace(ch);
+                }).base(), col.end());
+                bloom_columns.push_back(col);
+            }
+        }
+        size_t fpr_pos = upper_options.find("FPR", options_end);
+        if (fpr_pos != std::string::npos) {
+            std::stringstream fpr_ss(options.substr(fpr_pos + 3));
+            if (!(fpr_ss >> bloom_fpr) || bloom_fpr <= 0.0 || bloom_fpr >= 1.0) {
+                err << "Error: FPR must be a number between 0 and 1.\n";
+                return;
+            }
+        }
+        createTable(table_name, columns, bloom_columns, bloom_fpr, partitioning, &context);
+    }
+    else if (command == "INSERT") {
+        std::string into_keyword, table_name, values_keyword;
+        ss >> into_keyword >> table_name >> values_keyword;
+        std::transform(into_keyword.begin(), into_keyword.end(), into_keyword.begin(), ::toupper);
+        std::transform(values_keyword.begin(), values_keyword.end(), values_keyword.begin(), ::toupper);
+        if (into_keyword != "INTO" || values_keyword != "VALUES") {
+            err << "Error: Invalid syntax. Use 'INSERT INTO table_name VALUES (...)'\n";
+            return;
+        }
+        size_t pos1 = input.find('(');
+        size_t pos2 = input.find(')');
+        if (pos1 == std::string::npos || pos2 == std::string::npos || pos2 <= pos1 + 1) {
+            err << "Error: Invalid syntax for INSERT.\n";
+            return;
+        }
+        std::string vals = input.substr(pos1 + 1, pos2 - pos1 - 1);
+        std::vector<std::string> values;
+        std::stringstream vals_ss(vals);
+        std::string val;
+        while (std::getline(vals_ss, val, ',')) {
+            // Trim whitespace
+            val.erase(val.begin(), std::find_if(val.begin(), val.end(), [](unsigned char ch) {
+                return !std::isspace(ch);
+            }));
+            val.erase(std::find_if(val.rbegin(), val.rend(), [](unsigned char ch) {
+                return !std::isspace(ch);
+            }).base(), val.end());
+            // Remove quotes if present
+            if (!val.empty() && val.front() == '\'' && val.back() == '\'') {
+                val = val.substr(1, val.size() - 2);
+            }
+            values.push_back(val);
+        }
+        // Table growth counts against the global cap only
+        size_t row_bytes = sizeof(Record) + values.size() * sizeof(std::string_view);
+        for (const auto& value : values) {
+            row_bytes += value.size();
+        }
+        if (!MemoryTracker::instance().hasRoom(row_bytes)) {
+            err << "Error: Out of memory in INSERT: " << row_bytes << " more bytes would exceed the "
+                << MemoryTracker::instance().describe() << ".\n";
+            Metrics::instance().add(Counter::MEMORY_LIMIT_ERRORS);
+            return;
+        }
+        if (!lockTable(session, locks, table_name, true, context)) {
+            return;
+        }
+        Table* table = getTable(table_name, &context);
+        if (table) {
+            size_t bytes_before = table->memoryBytes();
+            table->insert(values, &context);
+            if (!session.in_transaction) {
+                table->save();
+            }
+            MemoryTracker::instance().adjustTableBytes(bytes_before, table->memoryBytes());
+            out << "Record inserted into " << table_name << ".\n";
+        }
+    }
+    else if (command == "SELECT") {
+        // Extract selected columns until 'FROM' is found
+        std::vector<std::string> selected_columns;
+        std::vector<std::pair<std::string, std::string>> aggregates; // aggregate function and column
+        std::string token;
+
+        while (ss >> token &&
+               token != "FROM" &&
+               token != "from" &&
+               token != "From") {
+            // Handle cases where columns are separated by commas
+            if (token.back() == ',') {
+                token.pop_back(); // Remove trailing comma
+            }
+            // Check for aggregate functions
+            size_t pos = token.find('(');
+            if (pos != std::string::npos && token.back() == ')') {
+                std::string func = token.substr(0, pos);
+                std::string arg = token.substr(pos + 1, token.size() - pos - 2);
+                std::transform(func.begin(), func.end(), func.begin(), ::toupper);
+                if (func == "COUNT" || func == "APPROX_COUNT_DISTINCT") {
+                    aggregates.emplace_back(func, arg);
+                }
+                else {
+                    err << "Error: Unsupported aggregate function '" << func << "'.\n";
+                    aggregates.clear();
+                    break;
+                }
+            }
+            else {
+                selected_columns.push_back(token);
+            }
+        }
+
+        // Check if 'FROM' keyword was found
+        if (!(token == "FROM" || token == "from" || token == "From")) {
+            err << "Error: Invalid syntax. Missing 'FROM'.\n";
+            return;
+        }
+
+        // Extract table name
+        std::string table_name;
+        ss >> table_name;
+        if (table_name.empty()) {
+            err << "Error: Missing table name after 'FROM'.\n";
+            return;
+        }
+
+        // Initialize variables for WHERE, ORDER BY, GROUP BY clauses
+        std::string clause;
+        std::string where_column, where_value;
+        std::vector<std::pair<std::string, std::string>> order_by; // column and direction
+        std::vector<std::string> group_by;
+
+        while (ss >> clause) {
+            std::string upper_clause = clause;
+            std::transform(upper_clause.begin(), upper_clause.end(), upper_clause.begin(), ::toupper);
+            if (upper_clause == "WHERE") {
+                ss >> where_column >> where_value;
+                // Remove potential semicolon at the end of where_value
+                if (!where_value.empty() && where_value.back() == ';') {
+                    where_value.pop_back();
+                }
+                // Remove quotes if present
+                if (!where_value.empty() && where_value.front() == '\'' && where_value.back() == '\'') {
+                    where_value = where_value.substr(1, where_value.size() - 2);
+                }
+            }
+            else if (upper_clause == "ORDER") {
+                std::string by;
+                ss >> by;
+                std::transform(by.begin(), by.end(), by.begin(), ::toupper);
+                if (by != "BY") {
+                    err << "Error: Invalid syntax after 'ORDER'. Did you mean 'ORDER BY'? \n";
+                    break;
+                }
+                // ORDER BY col [ASC|DESC], col [ASC|DESC], ...
+                std::string order_col;
+                while (ss >> order_col) {
+                    bool more = order_col.back() == ',';
+                    if (more) order_col.pop_back();
+                    std::string direction = "ASC";
+                    if (!more) {
+                        auto before_direction = ss.tellg();
+                        std::string token;
+                        if (ss >> token) {
+                            more = token.back() == ',';
+                            if (more) token.pop_back();
+                            std::transform(token.begin(), token.end(), token.begin(), ::toupper);
+                            if (token == "ASC" || token == "DESC") {
+                                direction = token;
+                            } else if (token.empty() && more) {
+                                // a lone ',' between keys
+                            } else {
+                                // Not a direction: leave it for the next clause
+                                ss.clear();
+                                ss.seekg(before_direction);
+                                more = false;
+                            }
+                        }
+                    }
+                    order_by.emplace_back(order_col, direction);
+                    if (!more) break;
+                }
+            }
+            else if (upper_clause == "GROUP") {
+                std::string by;
+                ss >> by;
+                std::transform(by.begin(), by.end(), by.begin(), ::toupper);
+                if (by != "BY") {
+                    err << "Error: Invalid syntax after 'GROUP'. Did you mean 'GROUP BY'? \n";
+                    break;
+                }
+                std::string group_col;
+                ss >> group_col;
+                group_by.emplace_back(group_col);
+            }
+            else {
+                err << "Error: Unrecognized clause '" << clause << "'.\n";
+                break;
+            }
+        }
+
+        // Handle '*' to select all columns
+        if (selected_columns.size() == 1 && selected_columns[0] == "*") {
+            selected_columns.clear(); // Passing an empty vector will indicate selecting all columns
+        }
+
+        // A materialized view is read from its maintained groups, without a scan
+        Table* view_table = tables.find(table_name) == tables.end() ? findViewTable(table_name) : nullptr;
+        if (view_table) {
+            if (!selected_columns.empty() || !aggregates.empty() || !where_column.empty() ||
+                !order_by.empty() || !group_by.empty()) {
+                err << "Error: Materialized view " << table_name << " supports only 'SELECT * FROM " << table_name << "'.\n";
+                return;
+            }
+            std::string view_table_name = view_table->getName();
+            if (!lockTable(session, locks, view_table_name, false, context)) {
+                return;
+            }
+            // Waiting for the lock may have let a ROLLBACK replace the table
+            view_table = getTable(view_table_name, &context);
+            const MaterializedView* view = view_table ? view_table->getView(table_name) : nullptr;
+            if (!view) {
+                err << "Error: Materialized view " << table_name << " not found.\n";
+                return;
+            }
+            if (explain && !analyze) {
+                out << "View " << table_name << ": read " << view->groupCount() << " maintained group(s) of "
+                    << view_table->getName() << ", no scan\n";
+                return;
+            }
+            QueryContext ctx(out, err);
+            ctx.memory.setLimit(session.memory_limit);
+            ctx.stats.profile = analyze;
+            ctx.stats.addStage("parse", statement_start, 0, 0);
+            auto stage_start = StageClock::now();
+            view->print(view_table->getColumns(), out);
+            ctx.stats.addStage("view", stage_start, view->groupCount(), view->groupCount(), view->memoryBytes());
+            Metrics::instance().add(Counter::ROWS_RETURNED, view->groupCount());
+            if (analyze) {
+                printProfile(ctx.stats, statement_start, &ctx);
+            }
+            return;
+        }
+
+        // Retrieve the table and perform the select operation
+        if (!lockTable(session, locks, table_name, false, context)) {
+            return;
+        }
+        Table* table = getTable(table_name, &context);
+        if (table) {
+            QueryContext ctx(out, err);
+            ctx.memory.setLimit(session.memory_limit);
+            if (explain && !analyze) {
+                table->explain(selected_columns, aggregates, where_column, where_value, order_by, group_by, &ctx);
+                return;
+            }
+            // Serve a repeated statement from the cache while the table is unchanged
+            bool cacheable = result_cache_enabled && !explain;
+            std::string cache_key, cached;
+            if (cacheable) {
+                cache_key = ResultCache::normalize(input);
+                if (result_cache.lookup(cache_key, table_name, table->getVersion(), cached)) {
+                    out << cached;
+                    return;
+                }
+            }
+            std::ostringstream result, errors;
+            if (cacheable) {
+                ctx.out = &result;
+                ctx.err = &errors;
+            }
+            ctx.stats.profile = analyze;
+            ctx.stats.addStage("parse", statement_start, 0, 0);
+            table->select(selected_columns, aggregates, where_column, where_value, order_by, group_by, &ctx);
+            if (cacheable) {
+                // Cache the result rows only: scan statistics belong to this run
+                ctx.out = &out;
+                ctx.err = &err;
+                out << result.str();
+                err << errors.str();
+                if (errors.str().empty()) {
+                    result_cache.store(cache_key, table_name, table->getVersion(), result.str());
+                }
+            }
+            if (!where_column.empty()) {
+                printQueryStats(ctx.stats, &ctx);
+            }
+            if (analyze) {
+                printProfile(ctx.stats, statement_start, &ctx);
+            }
+        }
+    }
+    else if (command == "UPDATE") {
+        std::string table_name, set_keyword;
+        ss >> table_name >> set_keyword;
+        std::transform(set_keyword.begin(), set_keyword.end(), set_keyword.begin(), ::toupper);
+        if (set_keyword != "SET") {
+            err << "Error: Invalid syntax. Did you mean 'SET'? \n";
+            return;
+        }
+        std::string set_column, equal_sign, set_value;
+        ss >> set_column >> equal_sign >> set_value;
+        if (equal_sign != "=") {
+            err << "Error: Invalid syntax for SET. Expected '='.\n";
+            return;
+        }
+
+        // Remove quotes if present
+        if (!set_value.empty() && set_value.front() == '\'' && set_value.back() == '\'') {
+            set_value = set_value.substr(1, set_value.size() - 2);
+        }
+
+        // Handle optional WHERE clause
+        std::string clause;
+        std::string where_column, where_value;
+        if (ss >> clause) {
+            std::string upper_clause = clause;
+            std::transform(upper_clause.begin(), upper_clause.end(), upper_clause.begin(), ::toupper);
+            if (upper_clause == "WHERE") {
+                ss >> where_column >> where_value;
+                // Remove potential semicolon at the end of where_value
+                if (!where_value.empty() && where_value.back() == ';') {
+                    where_value.pop_back();
+                }
+                // Remove quotes if present
+                if (!where_value.empty() && where_value.front() == '\'' && where_value.back() == '\'') {
+                    where_value = where_value.substr(1, where_value.size() - 2);
+                }
+            }
+            else {
+                err << "Error: Unrecognized clause '" << clause << "' in UPDATE.\n";
+                return;
+            }
+        }
+
+        if (!lockTable(session, locks, table_name, !explain || analyze, context)) {
+            return;
+        }
+        Table* table = getTable(table_name, &context);
+        if (table) {
+            QueryContext ctx(out, err);
+            ctx.memory.setLimit(session.memory_limit);
+            if (explain && !analyze) {
+                if (table->explainScan(where_column, where_value, &ctx)) {
+                    out << "Update: set " << set_column << " in place\n";
+                    if (!session.in_transaction) out << "Save: rewrite " << table_name << " files\n";
+                }
+                return;
+            }
+            ctx.stats.profile = analyze;
+            ctx.stats.addStage("parse", statement_start, 0, 0);
+            size_t bytes_before = table->memoryBytes();
+            table->update(set_column, set_value, where_column, where_value, &ctx);
+            if (!where_column.empty()) {
+                printQueryStats(ctx.stats, &ctx);
+            }
+            if (!session.in_transaction) {
+                auto save_start = StageClock::now();
+                table->save();
+                ctx.stats.addStage("save", save_start, table->rowCount(), table->rowCount(), 0,
+                                   analyze ? table->diskBytes() : 0);
+            }
+            MemoryTracker::instance().adjustTableBytes(bytes_before, table->memoryBytes());
+            if (analyze) {
+                printProfile(ctx.stats, statement_start, &ctx);
+            }
+        }
+    }
+    else if (command == "DELETE") {
+        std::string from_keyword, table_name;
+        ss >> from_keyword >> table_name;
+        std::transform(from_keyword.begin(), from_keyword.end(), from_keyword.begin(), ::toupper);
+        if (from_keyword != "FROM") {
+            err << "Error: Invalid syntax. Did you mean 'DELETE FROM'? \n";
+            return;
+        }
+
+        // Handle optional WHERE clause
+        std::string clause;
+        std::string where_column, where_value;
+        if (ss >> clause) {
+            std::string upper_clause = clause;
+            std::transform(upper_clause.begin(), upper_clause.end(), upper_clause.begin(), ::toupper);
+            if (upper_clause == "WHERE") {
+                ss >> where_column >> where_value;
+                // Remove potential semicolon at the end of where_value
+                if (!where_value.empty() && where_value.back() == ';') {
+                    where_value.pop_back();
+                }
+                // Remove quotes if present
+                if (!where_value.empty() && where_value.front() == '\'' && where_value.back() == '\'') {
+                    where_value = where_value.substr(1, where_value.size() - 2);
+                }
+            }
+            else {
+                err << "Error: Unrecognized clause '" << clause << "' in DELETE.\n";
+                return;
+            }
+        }
+
+        if (!lockTable(session, locks, table_name, !explain || analyze, context)) {
+            return;
+        }
+        Table* table = getTable(table_name, &context);
+        if (table) {
+            QueryContext ctx(out, err);
+            ctx.memory.setLimit(session.memory_limit);
+            if (explain && !analyze) {
+                if (table->explainScan(where_column, where_value, &ctx)) {
+                    out << "Delete: tombstone matching rows\n";
+                    if (!session.in_transaction) out << "Save: rewrite " << table_name << " files\n";
+                }
+                return;
+            }
+            ctx.stats.profile = analyze;
+            ctx.stats.addStage("parse", statement_start, 0, 0);
+            size_t bytes_before = table->memoryBytes();
+            table->deleteRecords(where_column, where_value, &ctx);
+            if (!where_column.empty()) {
+                printQueryStats(ctx.stats, &ctx);
+            }
+            if (!session.in_transaction) {
+                auto save_start = StageClock::now();
+                table->save();
+                ctx.stats.addStage("save", save_start, table->rowCount(), table->rowCount(), 0,
+                                   analyze ? table->diskBytes() : 0);
+            }
+            MemoryTracker::instance().adjustTableBytes(bytes_before, table->memoryBytes());
+            if (analyze) {
+                printProfile(ctx.stats, statement_start, &ctx);
+            }
+        }
+    }
+    else if (command == "SHOW") {
+        std::string target;
+        ss >> target;
+        std::transform(target.begin(), target.end(), target.begin(), ::toupper);
+        if (target == "TABLES") {
+            showTables(&context);
+        }
+        else if (target == "MEMORY") {
+            showMemory(&context);
+        }
+        else if (target == "STATS") {
+            showStats(&context);
+        }
+        else {
+            // Assume it's a table name
+            if (!lockTable(session, locks, target, false, context)) {
+                return;
+            }
+            showTable(target, &context);
+        }
+    }
+    else if (command == "SET") {
+        // SET name value, SET name = value
+        std::string name, value;
+        ss >> name >> value;
+        if (value == "=") {
+            ss >> value;
+        }
+        if (!name.empty() && name.back() == '=') {
+            name.pop_back();
+        }
+        if (!value.empty() && value.back() == ';') {
+            value.pop_back();
+        }
+        if (name.empty() || value.empty()) {
+            err << "Error: Invalid syntax. Use 'SET name = value'.\n";
+            return;
+        }
+        setOption(name, value, session, &context);
+    }
+    else if (command == "DROP") {
+        std::string materialized_keyword, view_keyword, view_name;
+        ss >> materialized_keyword >> view_keyword >> view_name;
+        std::transform(materialized_keyword.begin(), materialized_keyword.end(), materialized_keyword.begin(), ::toupper);
+        std::transform(view_keyword.begin(), view_keyword.end(), view_keyword.begin(), ::toupper);
+        if (!view_name.empty() && view_name.back() == ';') {
+            view_name.pop_back();
+        }
+        if (materialized_keyword != "MATERIALIZED" || view_keyword != "VIEW" || view_name.empty()) {
+            err << "Error: Invalid syntax. Use 'DROP MATERIALIZED VIEW name'.\n";
+            return;
+        }
+        if (Table* view_table = findViewTable(view_name)) {
+            if (!lockTable(session, locks, view_table->getName(), true, context)) {
+                return;
+            }
+        }
+        dropView(view_name, &context);
+    }
+    else if (command == "REFRESH") {
+        std::string materialized_keyword, view_keyword, view_name;
+        ss >> materialized_keyword >> view_keyword >> view_name;
+        std::transform(materialized_keyword.begin(), materialized_keyword.end(), materialized_keyword.begin(), ::toupper);
+        std::transform(view_keyword.begin(), view_keyword.end(), view_keyword.begin(), ::toupper);
+        if (!view_name.empty() && view_name.back() == ';') {
+            view_name.pop_back();
+        }
+        if (materialized_keyword != "MATERIALIZED" || view_keyword != "VIEW" || view_name.empty()) {
+            err << "Error: Invalid syntax. Use 'REFRESH MATERIALIZED VIEW name'.\n";
+            return;
+        }
+        if (Table* view_table = findViewTable(view_name)) {
+            if (!lockTable(session, locks, view_table->getName(), true, context)) {
+                return;
+            }
+        }
+        refreshView(view_name, &context);
+    }
+    else if (command == "ALTER") {
+        // ALTER TABLE name ADD PARTITION p VALUES LESS THAN (bound|MAXVALUE)
+        // ALTER TABLE name DROP PARTITION p
+        std::string table_keyword, table_name, action, partition_keyword, partition_name;
+        ss >> table_keyword >> table_name >> action >> partition_keyword >> partition_name;
+        std::transform(table_keyword.begin(), table_keyword.end(), table_keyword.begin(), ::toupper);
+        std::transform(action.begin(), action.end(), action.begin(), ::toupper);
+        std::transform(partition_keyword.begin(), partition_keyword.end(), partition_keyword.begin(), ::toupper);
+        if (!partition_name.empty() && partition_name.back() == ';') {
+            partition_name.pop_back();
+        }
+        if (table_keyword != "TABLE" || (action != "ADD" && action != "DROP") || partition_keyword != "PARTITION" ||
+            partition_name.empty()) {
+            err << "Error: Invalid syntax. Use 'ALTER TABLE name ADD PARTITION p VALUES LESS THAN (bound)' "
+                << "or 'ALTER TABLE name DROP PARTITION p'.\n";
+            return;
+        }
+        if (!lockTable(session, locks, table_name, true, context)) {
+            return;
+        }
+        if (action == "DROP") {
+            dropPartition(table_name, partition_name, &context);
+            return;
+        }
+        std::string values_keyword, less_keyword, than_keyword, bound;
+        ss >> values_keyword >> less_keyword >> than_keyword;
+        std::getline(ss, bound);
+        std::string keywords = values_keyword + " " + less_keyword + " " + than_keyword;
+        std::transform(keywords.begin(), keywords.end(), keywords.begin(), ::toupper);
+        bound.erase(bound.begin(), std::find_if(bound.begin(), bound.end(), [](unsigned char ch) {
+            return !std::isspace(ch);
+        }));
+        bound.erase(std::find_if(bound.rbegin(), bound.rend(), [](unsigned char ch) {
+            return !std::isspace(ch) && ch != ';';
+        }).base(), bound.end());
+        if (keywords != "VALUES LESS THAN" || bound.empty()) {
+            err << "Error: Invalid syntax. Use 'ALTER TABLE name ADD PARTITION p VALUES LESS THAN (bound)'.\n";
+            return;
+        }
+        std::string upper_bound = bound;
+        std::transform(upper_bound.begin(), upper_bound.end(), upper_bound.begin(), ::toupper);
+        if (upper_bound == "MAXVALUE") {
+            bound.clear();
+        } else if (bound.front() == '(' && bound.back() == ')') {
+            bound = bound.substr(1, bound.size() - 2);
+            if (bound.size() >= 2 && bound.front() == '\'' && bound.back() == '\'') {
+                bound = bound.substr(1, bound.size() - 2);
+            }
+        }
+        addPartition(table_name, partition_name, bound, &context);
+    }
+    else if (command == "DESCRIBE") {
+        std::string table_name;
+        ss >> table_name;
+        if (table_name.empty()) {
+            err << "Error: Missing table name for DESCRIBE.\n";
+            return;
+        }
+        if (!lockTable(session, locks, table_name, false, context)) {
+            return;
+        }
+        describeTable(table_name, &context);
+    }
+    else if (command == "VACUUM") {
+        std::string table_name;
+        ss >> table_name;
+        if (!table_name.empty() && table_name.back() == ';') {
+            table_name.pop_back();
+        }
+        // Without a name, every table in turn, each locked only while it is vacuumed
+        std::vector<std::string> targets;
+        if (table_name.empty()) {
+            for (const auto& pair : tables) {
+                targets.push_back(pair.first);
+            }
+        } else {
+            targets.push_back(table_name);
+        }
+        for (const auto& target : targets) {
+            if (!lockTable(session, locks, target, true, context)) {
+                return;
+            }
+            Table* table = getTable(target, &context);
+            if (!table) {
+                return;
+            }
+            size_t bytes_before = table->memoryBytes();
+            size_t reclaimed = table->vacuum();
+            if (!session.in_transaction) {
+                table->save();
+            }
+            MemoryTracker::instance().adjustTableBytes(bytes_before, table->memoryBytes());
+            out << "Vacuumed " << table->getName() << ": reclaimed " << reclaimed << " row(s).\n";
+        }
+    }
+    else if (command == "ANALYZE") {
+        std::string table_name;
+        ss >> table_name;
+        if (!table_name.empty() && table_name.back() == ';') {
+            table_name.pop_back();
+        }
+        std::vector<std::string> targets;
+        if (table_name.empty()) {
+            for (const auto& pair : tables) {
+                targets.push_back(pair.first);
+            }
+        } else {
+            targets.push_back(table_name);
+        }
+        for (const auto& target : targets) {
+            if (!lockTable(session, locks, target, true, context)) {
+                return;
+            }
+            Table* table = getTable(target, &context);
+            if (!table) {
+                return;
+            }
+            table->analyze();
+            if (!session.in_transaction && !table->saveStats()) {
+                err << "Error: Unable to write statistics for " << table->getName() << ".\n";
+            }
+            out << "Analyzed " << table->getName() << ": " << table->rowCount() << " row(s).\n";
+        }
+    }
+    else if (command == "BEGIN") {
+        std::string transaction_keyword;
+        ss >> transaction_keyword;
+        std::transform(transaction_keyword.begin(), transaction_keyword.end(), transaction_keyword.begin(), ::toupper);
+        if (transaction_keyword != "TRANSACTION" && transaction_keyword != "TRANSACTION;") {
+            err << "Error: Invalid syntax. Use 'BEGIN TRANSACTION'.\n";
+            return;
+        }
+        beginTransaction(session, &context);
+    }
+    else if (command == "COMMIT") {
+        commitTransaction(session, &context);
+    }
+    else if (command == "ROLLBACK") {
+        rollbackTransaction(session, &context);
+    }
+    else {
+        err << "Error: Unrecognized command.\n";
+    }
+}
@@ -1,38 +1,119 @@
-// Database.hpp
-#ifndef DATABASE_HPP
-#define DATABASE_HPP
-
-#include "Table.hpp"
-#include <unordered_map>
-#include <memory>
-#include <vector>
-#include <string>
-
-class Database {
-private:
-    std::unordered_map<std::string, std::unique_ptr<Table>> tables;
-    // Transaction support
-    bool transaction_active = false;
-    std::unordered_map<std::string, std::unique_ptr<Table>> table_backups;
-
-    void autoLoadTables(); // Added for auto-loading tables on start
-
-public:
-    Database() = default;
-
-    void createTable(const std::string& name, const std::vector<std::string>& columns);
-    void loadTable(const std::string& name);
-    Table* getTable(const std::string& name);
-    void showTables();
-    void showTable(const std::string& name);
-    void describeTable(const std::string& name);
-
-    // Transaction methods
-    void beginTransaction();
-    void commitTransaction();
-    void rollbackTransaction();
-
-    void run();
-};
-
-#endif // DATABASE_HPP
\ No newline at end of file
+// Database.hpp
+#ifndef DATABASE_HPP
+#define DATABASE_HPP
+
+#include "Table.hpp"
+#include "ResultCache.hpp"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+#include <string>
+
+// Longest a statement in a transaction waits for a table lock. Transactions
+// keep their locks between statements, so two of them can wait on each other.
+const std::chrono::seconds TRANSACTION_LOCK_TIMEOUT(5);
+
+// One client of execute(): where its statements write, and its open transaction.
+// A transaction backs up each table on its first write to it and keeps that
+// table locked exclusively until COMMIT or ROLLBACK.
+struct Session {
+    std::ostream* out = &std::cout;
+    std::ostream* err = &std::cerr;
+    bool in_transaction = false;
+    std::map<std::string, std::unique_lock<std::shared_timed_mutex>> transaction_locks;
+    std::map<std::string, std::unique_ptr<Table>> table_backups;
+    size_t transaction_memory = 0; // reserved with MemoryTracker for the backups
+    size_t memory_limit = 0; // SET memory_limit: per statement and for transaction backups; 0 = none
+
+    Session() = default;
+    Session(std::ostream& out, std::ostream& err) : out(&out), err(&err) {}
+};
+
+class Database {
+private:
+    std::unordered_map<std::string, std::unique_ptr<Table>> tables;
+
+    // Statements hold catalog_lock shared and one table's lock at a time, shared
+    // (reads) or exclusive (writes). Changing the set of tables or views, and
+    // ROLLBACK, take catalog_lock exclusively. Nobody waits for a table lock
+    // while holding the catalog: a transaction holding that table may need the
+    // catalog to finish.
+    std::shared_mutex catalog_lock;
+    std::unordered_map<std::string, std::unique_ptr<std::shared_timed_mutex>> table_locks;
+
+    // Opt-in SELECT result cache (SET result_cache ON)
+    std::atomic<bool> result_cache_enabled{false};
+    ResultCache result_cache;
+
+    struct StatementLocks {
+        std::shared_lock<std::shared_mutex> catalog_shared;
+        std::unique_lock<std::shared_mutex> catalog_exclusive;
+        std::shared_lock<std::shared_timed_mutex> table_shared;
+        std::unique_lock<std::shared_timed_mutex> table_exclusive;
+    };
+
+    void addTable(const std::string& name, std::unique_ptr<Table> table);
+    // Lock a table for the statement, releasing any table it held before. In a
+    // transaction a write lock is kept, and the table backed up, until the
+    // transaction ends. Returns false, after reporting why, if the lock (or the
+    // backup's memory) is not available.
+    bool lockTable(Session& session, StatementLocks& locks, const std::string& name, bool exclusive,
+                   QueryContext& context);
+    bool backupTable(Session& session, const std::string& name, QueryContext& context);
+    // Table that holds the materialized view, or nullptr
+    Table* findViewTable(const std::string& view_name);
+
+public:
+    Database() = default;
+
+    void autoLoadTables(QueryContext* ctx = nullptr); // Added for auto-loading tables on start
+    void createTable(const std::string& name, const std::vector<std::string>& columns,
+                     const std::vector<std::string>& bloom_columns = {},
+                     double bloom_fpr = DEFAULT_BLOOM_FPR,
+                     const PartitionSpec& partitioning = PartitionSpec(),
+                     QueryContext* ctx = nullptr);
+    void loadTable(const std::string& name, QueryContext* ctx = nullptr);
+    void createView(const std::string& view_name, const std::string& table_name,
+                    const std::vector<std::string>& group_by,
+                    const std::vector<std::pair<std::string, std::string>>& aggregates,
+                    QueryContext* ctx = nullptr);
+    void dropView(const std::string& view_name, QueryContext* ctx = nullptr);
+    void refreshView(const std::string& view_name, QueryContext* ctx = nullptr);
+    // ALTER TABLE name ADD PARTITION p VALUES LESS THAN (bound) / DROP PARTITION p
+    void addPartition(const std::string& table_name, const std::string& partition,
+                      const std::string& upper_bound, QueryContext* ctx = nullptr);
+    void dropPartition(const std::string& table_name, const std::string& partition, QueryContext* ctx = nullptr);
+    Table* getTable(const std::string& name, QueryContext* ctx = nullptr);
+    void showTables(QueryContext* ctx = nullptr);
+    void showTable(const std::string& name, QueryContext* ctx = nullptr);
+    void describeTable(const std::string& name, QueryContext* ctx = nullptr);
+    void showMemory(QueryContext* ctx = nullptr);
+    void showStats(QueryContext* ctx = nullptr);
+    // SET name [=] value; memory_limit applies to the session
+    void setOption(const std::string& name, const std::string& value, Session& session, QueryContext* ctx = nullptr);
+    // Refresh per-table gauges for SHOW STATS and the metrics dump. With wait
+    // false, gives up and returns false if the catalog is taken, and tables
+    // someone else has locked keep their last gauges.
+    bool publishTableMetrics(Session* session = nullptr, bool wait = true);
+    void printQueryStats(const QueryStats& stats, QueryContext* ctx = nullptr);
+    void printProfile(const QueryStats& stats, StageClock::time_point statement_start,
+                      QueryContext* ctx = nullptr);
+
+    // Transaction methods; ROLLBACK needs catalog_lock held exclusively
+    void beginTransaction(Session& session, QueryContext* ctx = nullptr);
+    void commitTransaction(Session& session, QueryContext* ctx = nullptr);
+    void rollbackTransaction(Session& session, QueryContext* ctx = nullptr);
+
+    // Parse and run one statement; safe to call from several sessions at once
+    void execute(const std::string& input, Session& session);
+    // Roll back a transaction the session left open
+    void endSession(Session& session);
+    void run();
+};
+
+#endif // DATABASE_HPP
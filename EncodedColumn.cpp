@@ -0,0 +1,283 @@
+// EncodedColumn.cpp
+#include "EncodedColumn.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include <sstream>
+#include <limits>
+#include <cctype>
+
+namespace {
+
+// Columns with more distinct values than this are not dictionary encoded
+const size_t MAX_DICTIONARY_SIZE = 65536;
+
+// Accepts only the canonical spelling ("42", "-7"), so decoding reproduces the text exactly
+bool parseCanonicalInt(std::string_view s, long long& out) {
+    if (s.empty() || s.size() > 18) return false;
+    size_t i = (s[0] == '-') ? 1 : 0;
+    if (i == s.size()) return false;
+    if (s[i] == '0' && (s.size() > i + 1 || i == 1)) return false;
+    long long v = 0;
+    for (size_t j = i; j < s.size(); ++j) {
+        if (!std::isdigit(static_cast<unsigned char>(s[j]))) return false;
+        v = v * 10 + (s[j] - '0');
+    }
+    out = i == 1 ? -v : v;
+    return true;
+}
+
+template <typename T>
+void writeNumbers(std::ostream& os, const std::vector<T>& values) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i != 0) os << ' ';
+        os << values[i];
+    }
+    os << "\n";
+}
+
+template <typename T>
+bool readNumbers(std::istream& is, size_t count, std::vector<T>& values) {
+    std::string line;
+    if (!std::getline(is, line)) return false;
+    std::stringstream ss(line);
+    values.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!(ss >> values[i])) return false;
+    }
+    return true;
+}
+
+}
+
+EncodedColumn EncodedColumn::encode(const std::vector<const Record*>& rows, size_t column) {
+    EncodedColumn col;
+    size_t n = rows.size();
+    col.row_count = n;
+    if (n == 0) return col;
+
+    // Repetitive or sorted columns: run-length encode
+    size_t runs = 1;
+    for (size_t row = 1; row < n; ++row) {
+        if (rows[row]->fields[column] != rows[row - 1]->fields[column]) runs++;
+    }
+    if (runs * 4 <= n) {
+        std::vector<std::string> values;
+        for (size_t row = 0; row < n; ++row) {
+            if (row == 0 || rows[row]->fields[column] != rows[row - 1]->fields[column]) {
+                values.emplace_back(rows[row]->fields[column]);
+            }
+        }
+        col.dictionary = values;
+        std::sort(col.dictionary.begin(), col.dictionary.end());
+        col.dictionary.erase(std::unique(col.dictionary.begin(), col.dictionary.end()), col.dictionary.end());
+        size_t value_idx = 0;
+        for (size_t row = 1; row <= n; ++row) {
+            if (row == n || rows[row]->fields[column] != rows[row - 1]->fields[column]) {
+                auto it = std::lower_bound(col.dictionary.begin(), col.dictionary.end(), values[value_idx++]);
+                col.codes.push_back(static_cast<uint32_t>(it - col.dictionary.begin()));
+                col.run_ends.push_back(row);
+            }
+        }
+        col.encoding = Encoding::RLE;
+        return col;
+    }
+
+    // Integer columns with a narrow range: frame of reference
+    long long lo = std::numeric_limits<long long>::max();
+    long long hi = std::numeric_limits<long long>::min();
+    bool integers = true;
+    for (const Record* record : rows) {
+        long long v;
+        if (!parseCanonicalInt(record->fields[column], v)) {
+            integers = false;
+            break;
+        }
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+    }
+    if (integers && static_cast<unsigned long long>(hi - lo) <= std::numeric_limits<uint32_t>::max()) {
+        col.base = lo;
+        col.offsets.reserve(n);
+        for (const Record* record : rows) {
+            long long v = 0;
+            parseCanonicalInt(record->fields[column], v);
+            col.offsets.push_back(static_cast<uint32_t>(v - lo));
+        }
+        col.encoding = Encoding::FOR;
+        return col;
+    }
+
+    // Low-cardinality columns: dictionary
+    std::unordered_map<std::string_view, uint32_t> ids;
+    size_t limit = std::min(MAX_DICTIONARY_SIZE, n / 4);
+    for (const Record* record : rows) {
+        if (ids.emplace(record->fields[column], 0).second && ids.size() > limit) {
+            return col; // too many distinct values, stay PLAIN
+        }
+    }
+    col.dictionary.reserve(ids.size());
+    for (const auto& pair : ids) {
+        col.dictionary.emplace_back(pair.first);
+    }
+    // Sorted dictionary keeps code order equal to value order
+    std::sort(col.dictionary.begin(), col.dictionary.end());
+    for (size_t i = 0; i < col.dictionary.size(); ++i) {
+        ids[col.dictionary[i]] = static_cast<uint32_t>(i);
+    }
+    col.codes.reserve(n);
+    for (const Record* record : rows) {
+        col.codes.push_back(ids[record->fields[column]]);
+    }
+    col.encoding = Encoding::DICT;
+    return col;
+}
+
+const char* EncodedColumn::encodingName() const {
+    switch (encoding) {
+        case Encoding::DICT: return "DICT";
+        case Encoding::RLE: return "RLE";
+        case Encoding::FOR: return "FOR";
+        default: return "PLAIN";
+    }
+}
+
+size_t EncodedColumn::runAt(size_t row) const {
+    return std::upper_bound(run_ends.begin(), run_ends.end(), row) - run_ends.begin();
+}
+
+uint32_t EncodedColumn::codeAt(size_t row) const {
+    switch (encoding) {
+        case Encoding::DICT: return codes[row];
+        case Encoding::RLE: return codes[runAt(row)];
+        case Encoding::FOR: return offsets[row];
+        default: return 0;
+    }
+}
+
+std::string EncodedColumn::decode(uint32_t code) const {
+    if (encoding == Encoding::FOR) {
+        return std::to_string(base + static_cast<long long>(code));
+    }
+    if (code < dictionary.size()) {
+        return dictionary[code];
+    }
+    return "";
+}
+
+bool EncodedColumn::lookupCode(const std::string& value, uint32_t& code) const {
+    if (encoding == Encoding::FOR) {
+        long long v;
+        if (!parseCanonicalInt(value, v) || v < base ||
+            static_cast<unsigned long long>(v - base) > std::numeric_limits<uint32_t>::max()) {
+            return false;
+        }
+        code = static_cast<uint32_t>(v - base);
+        return true;
+    }
+    auto it = std::lower_bound(dictionary.begin(), dictionary.end(), value);
+    if (it == dictionary.end() || *it != value) {
+        return false;
+    }
+    code = static_cast<uint32_t>(it - dictionary.begin());
+    return true;
+}
+
+void EncodedColumn::findEqual(const std::string& value, size_t begin, size_t end, std::vector<size_t>& out) const {
+    uint32_t code;
+    end = std::min(end, row_count);
+    if (begin >= end || !lookupCode(value, code)) {
+        return;
+    }
+    if (encoding == Encoding::DICT) {
+        for (size_t row = begin; row < end; ++row) {
+            if (codes[row] == code) out.push_back(row);
+        }
+    } else if (encoding == Encoding::FOR) {
+        for (size_t row = begin; row < end; ++row) {
+            if (offsets[row] == code) out.push_back(row);
+        }
+    } else if (encoding == Encoding::RLE) {
+        // Whole runs match or miss at once
+        for (size_t run = runAt(begin); run < run_ends.size(); ++run) {
+            size_t run_begin = run == 0 ? 0 : run_ends[run - 1];
+            if (run_begin >= end) break;
+            if (codes[run] == code) {
+                for (size_t row = std::max(run_begin, begin); row < std::min(run_ends[run], end); ++row) {
+                    out.push_back(row);
+                }
+            }
+        }
+    }
+}
+
+void EncodedColumn::write(std::ostream& os) const {
+    switch (encoding) {
+        case Encoding::DICT:
+            os << "COLUMN DICT " << dictionary.size() << "\n";
+            for (const auto& value : dictionary) os << value << "\n";
+            writeNumbers(os, codes);
+            break;
+        case Encoding::RLE: {
+            os << "COLUMN RLE " << dictionary.size() << " " << codes.size() << "\n";
+            for (const auto& value : dictionary) os << value << "\n";
+            writeNumbers(os, codes);
+            std::vector<size_t> lengths;
+            for (size_t run = 0; run < run_ends.size(); ++run) {
+                lengths.push_back(run_ends[run] - (run == 0 ? 0 : run_ends[run - 1]));
+            }
+            writeNumbers(os, lengths);
+            break;
+        }
+        case Encoding::FOR:
+            os << "COLUMN FOR " << base << "\n";
+            writeNumbers(os, offsets);
+            break;
+        default:
+            os << "COLUMN PLAIN\n";
+            break;
+    }
+}
+
+bool EncodedColumn::read(std::istream& is, const std::string& tag_line, size_t rows) {
+    std::stringstream tag(tag_line);
+    std::string column_keyword, kind;
+    tag >> column_keyword >> kind;
+    if (column_keyword != "COLUMN") return false;
+    *this = EncodedColumn();
+    row_count = rows;
+
+    if (kind == "DICT" || kind == "RLE") {
+        size_t dict_size = 0, run_count = rows;
+        if (!(tag >> dict_size)) return false;
+        if (kind == "RLE" && !(tag >> run_count)) return false;
+        dictionary.resize(dict_size);
+        for (auto& value : dictionary) {
+            if (!std::getline(is, value)) return false;
+        }
+        if (!readNumbers(is, run_count, codes)) return false;
+        for (uint32_t code : codes) {
+            if (code >= dict_size) return false;
+        }
+        if (kind == "RLE") {
+            std::vector<size_t> lengths;
+            if (!readNumbers(is, run_count, lengths)) return false;
+            size_t end = 0;
+            for (size_t length : lengths) {
+                end += length;
+                run_ends.push_back(end);
+            }
+            if (end != rows) return false;
+            encoding = Encoding::RLE;
+        } else {
+            encoding = Encoding::DICT;
+        }
+        return true;
+    }
+    if (kind == "FOR") {
+        if (!(tag >> base)) return false;
+        if (!readNumbers(is, rows, offsets)) return false;
+        encoding = Encoding::FOR;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,55 @@
+// EncodedColumn.hpp
+#ifndef ENCODEDCOLUMN_HPP
+#define ENCODEDCOLUMN_HPP
+
+#include "Record.hpp"
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+
+enum class Encoding { PLAIN, DICT, RLE, FOR };
+
+// Compressed copy of one column, chosen automatically at checkpoint time.
+// Every encoding maps a row to a 32-bit code, so filters and grouping can
+// work on codes and only decode the values they print.
+class EncodedColumn {
+private:
+    Encoding encoding = Encoding::PLAIN;
+    size_t row_count = 0;
+    std::vector<std::string> dictionary; // DICT, RLE: sorted distinct values
+    std::vector<uint32_t> codes;         // DICT: code per row, RLE: code per run
+    std::vector<size_t> run_ends;        // RLE: exclusive end row of each run
+    long long base = 0;                  // FOR: frame of reference (minimum)
+    std::vector<uint32_t> offsets;       // FOR: value - base per row
+
+    size_t runAt(size_t row) const;
+
+public:
+    EncodedColumn() = default;
+
+    // Pick the cheapest encoding for records[*].fields[column]; PLAIN if none pays off
+    static EncodedColumn encode(const std::vector<const Record*>& rows, size_t column);
+
+    bool isEncoded() const { return encoding != Encoding::PLAIN; }
+    Encoding getEncoding() const { return encoding; }
+    const char* encodingName() const;
+    size_t size() const { return row_count; }
+    size_t dictionarySize() const { return dictionary.size(); }
+
+    uint32_t codeAt(size_t row) const;
+    std::string decode(uint32_t code) const;
+    std::string valueAt(size_t row) const { return decode(codeAt(row)); }
+
+    // Code that value would have; false if no row can hold it
+    bool lookupCode(const std::string& value, uint32_t& code) const;
+    // Append rows in [begin, end) equal to value, comparing codes only
+    void findEqual(const std::string& value, size_t begin, size_t end, std::vector<size_t>& out) const;
+
+    // Writes the "COLUMN <kind> ..." tag line and the payload; read() gets the tag line already consumed
+    void write(std::ostream& os) const;
+    bool read(std::istream& is, const std::string& tag_line, size_t rows);
+};
+
+#endif // ENCODEDCOLUMN_HPP
@@ -0,0 +1,19 @@
+// Hash.hpp
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <cstdint>
+
+// splitmix64 finalizer. std::hash may leave the high bits poorly mixed;
+// the Bloom filter also uses it to derive its second hash, so both
+// sketches share this one definition.
+inline uint64_t mixHash(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+#endif // HASH_HPP
@@ -0,0 +1,71 @@
+// Histogram.cpp
+#include "Histogram.hpp"
+#include <algorithm>
+#include <cmath>
+
+size_t Histogram::bucketIndex(uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    unsigned msb = 63 - __builtin_clzll(value);
+    unsigned shift = msb - SUB_BUCKET_BITS;
+    size_t sub = static_cast<size_t>(value >> shift) - SUB_BUCKETS; // 0..SUB_BUCKETS-1
+    return 2 * SUB_BUCKETS + (shift - 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t Histogram::bucketUpperBound(size_t index) {
+    if (index < 2 * SUB_BUCKETS) {
+        return index;
+    }
+    size_t shift = (index - 2 * SUB_BUCKETS) / SUB_BUCKETS + 1;
+    uint64_t sub = (index - 2 * SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value) {
+    counts[bucketIndex(value)]++;
+    total++;
+    sum += value;
+    min_value = std::min(min_value, value);
+    max_value = std::max(max_value, value);
+}
+
+void Histogram::merge(const Histogram& other) {
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    min_value = std::min(min_value, other.min_value);
+    max_value = std::max(max_value, other.max_value);
+}
+
+void Histogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    sum = 0;
+    min_value = UINT64_MAX;
+    max_value = 0;
+}
+
+uint64_t Histogram::percentile(double p) const {
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(p * total));
+    rank = std::max<uint64_t>(1, std::min(rank, total));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(i), max_value);
+        }
+    }
+    return max_value;
+}
+
+uint64_t Histogram::countAtOrBelow(uint64_t bound) const {
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size() && bucketUpperBound(i) <= bound; ++i) {
+        seen += counts[i];
+    }
+    return seen;
+}
@@ -0,0 +1,45 @@
+// Histogram.hpp
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// HDR-style log-linear histogram: exact below 128, then 64 linear
+// sub-buckets per power of two (under 1.6% relative error) up to 2^64.
+// Not thread-safe; keep one per thread and merge().
+class Histogram {
+private:
+    static const unsigned SUB_BUCKET_BITS = 6;
+    static const size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const size_t BUCKET_COUNT = 2 * SUB_BUCKETS + (64 - SUB_BUCKET_BITS - 1) * SUB_BUCKETS;
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t min_value = UINT64_MAX;
+    uint64_t max_value = 0;
+
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(size_t index);
+
+public:
+    Histogram() : counts(BUCKET_COUNT, 0) {}
+
+    void record(uint64_t value);
+    void merge(const Histogram& other);
+    void reset();
+
+    uint64_t count() const { return total; }
+    uint64_t getSum() const { return sum; }
+    uint64_t min() const { return total ? min_value : 0; }
+    uint64_t max() const { return max_value; }
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+    // Smallest bucket bound with at least p (0..1) of the samples at or below it
+    uint64_t percentile(double p) const;
+    // Samples at or below bound, for cumulative (Prometheus-style) buckets
+    uint64_t countAtOrBelow(uint64_t bound) const;
+};
+
+#endif // HISTOGRAM_HPP
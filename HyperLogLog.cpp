@@ -0,0 +1,72 @@
+// HyperLogLog.cpp
+#include "HyperLogLog.hpp"
+#include "Hash.hpp"
+#include <cmath>
+#include <functional>
+
+HyperLogLog::HyperLogLog(unsigned precision) : precision(precision), registers(size_t(1) << precision, 0) {}
+
+void HyperLogLog::add(std::string_view value) {
+    uint64_t hash = mixHash(std::hash<std::string_view>{}(value));
+    size_t index = hash >> (64 - precision);
+    uint64_t rest = hash << precision;
+    // Position of the first set bit in the remaining bits, 1-based
+    uint8_t rank = rest == 0 ? 64 - precision + 1 : __builtin_clzll(rest) + 1;
+    if (rank > registers[index]) {
+        registers[index] = rank;
+    }
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+    if (other.precision != precision) return;
+    for (size_t i = 0; i < registers.size(); ++i) {
+        if (other.registers[i] > registers[i]) registers[i] = other.registers[i];
+    }
+}
+
+uint64_t HyperLogLog::estimate() const {
+    double m = static_cast<double>(registers.size());
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (uint8_t r : registers) {
+        sum += std::ldexp(1.0, -r);
+        if (r == 0) zeros++;
+    }
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double raw = alpha * m * m / sum;
+    // Small cardinalities: linear counting over empty registers is more accurate
+    if (raw <= 2.5 * m && zeros > 0) {
+        return static_cast<uint64_t>(std::llround(m * std::log(m / zeros)));
+    }
+    return static_cast<uint64_t>(std::llround(raw));
+}
+
+std::string HyperLogLog::serialize() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(registers.size() * 2);
+    for (uint8_t r : registers) {
+        hex += digits[r >> 4];
+        hex += digits[r & 0xf];
+    }
+    return hex;
+}
+
+bool HyperLogLog::deserialize(const std::string& hex) {
+    if (hex.size() != registers.size() * 2) {
+        return false;
+    }
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    };
+    std::vector<uint8_t> loaded(registers.size());
+    for (size_t i = 0; i < loaded.size(); ++i) {
+        int high = nibble(hex[2 * i]), low = nibble(hex[2 * i + 1]);
+        if (high < 0 || low < 0) return false;
+        loaded[i] = static_cast<uint8_t>(high << 4 | low);
+    }
+    registers = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,33 @@
+// HyperLogLog.hpp
+#ifndef HYPERLOGLOG_HPP
+#define HYPERLOGLOG_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Default precision: 2^12 registers, about 1.6% standard error
+const unsigned DEFAULT_HLL_PRECISION = 12;
+
+// Distinct-count sketch (Flajolet et al. with the small-range correction)
+class HyperLogLog {
+private:
+    unsigned precision;
+    std::vector<uint8_t> registers;
+
+public:
+    explicit HyperLogLog(unsigned precision = DEFAULT_HLL_PRECISION);
+
+    void add(std::string_view value);
+    // Both sketches must have the same precision
+    void merge(const HyperLogLog& other);
+    uint64_t estimate() const;
+    unsigned getPrecision() const { return precision; }
+
+    // Registers as hex, one line
+    std::string serialize() const;
+    bool deserialize(const std::string& hex);
+};
+
+#endif // HYPERLOGLOG_HPP
@@ -0,0 +1,232 @@
+// MaterializedView.cpp
+#include "MaterializedView.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+// An overflowed SUM is trusted again once its REAL sum is this far inside
+// the 64-bit range, well clear of any rounding error near the boundary
+constexpr double SUM_BACK_IN_RANGE = 4611686018427387904.0; // 2^62
+
+// Numeric value of a field for SUM: integers exactly, anything else strtod accepts as a double
+bool parseNumber(std::string_view value, long long& integer, double& real, bool& integral) {
+    auto result = std::from_chars(value.data(), value.data() + value.size(), integer);
+    if (result.ec == std::errc() && result.ptr == value.data() + value.size()) {
+        integral = true;
+        real = static_cast<double>(integer);
+        return true;
+    }
+    std::string text(value);
+    char* end = nullptr;
+    real = std::strtod(text.c_str(), &end);
+    integral = false;
+    return end == text.c_str() + text.size();
+}
+
+}
+
+MaterializedView::MaterializedView(const std::string& name, const std::vector<int>& group_columns,
+                                   const std::vector<ViewAggregate>& aggregates)
+    : name(name), group_columns(group_columns), aggregates(aggregates) {}
+
+void MaterializedView::apply(const Record& record, bool add) {
+    std::string key;
+    for (int idx : group_columns) {
+        key.append(record.fields[idx]);
+        key += '\x1f';
+    }
+    auto it = groups.find(key);
+    if (it == groups.end()) {
+        if (!add) return;
+        Group group;
+        for (int idx : group_columns) {
+            group.key.emplace_back(record.fields[idx]);
+        }
+        group.states.resize(aggregates.size());
+        it = groups.emplace(std::move(key), std::move(group)).first;
+    }
+    Group& group = it->second;
+    add ? group.rows++ : group.rows--;
+    for (size_t i = 0; i < aggregates.size(); ++i) {
+        const ViewAggregate& aggregate = aggregates[i];
+        if (aggregate.column < 0) continue; // COUNT(*) reads group.rows
+        std::string_view value = record.fields[aggregate.column];
+        if (value.empty()) continue;
+        AggregateState& state = group.states[i];
+        add ? state.count++ : state.count--;
+        if (aggregate.function == "SUM") {
+            long long integer = 0;
+            double real = 0.0;
+            bool integral = false;
+            if (!parseNumber(value, integer, real, integral)) continue;
+            if (integral) {
+                // Wrapping keeps the low 64 bits of the true sum
+                if (add ? __builtin_add_overflow(state.integer_sum, integer, &state.integer_sum)
+                        : __builtin_sub_overflow(state.integer_sum, integer, &state.integer_sum)) {
+                    state.overflowed = true;
+                }
+            } else {
+                add ? state.fractional++ : state.fractional--;
+            }
+            state.real_sum += add ? real : -real;
+            if (state.overflowed && std::fabs(state.real_sum) < SUM_BACK_IN_RANGE) {
+                state.overflowed = false;
+            }
+            if (!add && state.fractional > 0) {
+                drifted = true;
+            }
+        }
+        else if (aggregate.function == "MIN" || aggregate.function == "MAX") {
+            if (add) {
+                state.values[std::string(value)]++;
+            } else {
+                auto entry = state.values.find(value);
+                if (entry != state.values.end() && --entry->second == 0) {
+                    state.values.erase(entry);
+                }
+            }
+        }
+    }
+    if (group.rows == 0) {
+        groups.erase(it);
+    }
+}
+
+void MaterializedView::rebuild(const std::vector<const Record*>& rows) {
+    groups.clear();
+    drifted = false;
+    for (const Record* record : rows) {
+        addRow(*record);
+    }
+}
+
+size_t MaterializedView::memoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& pair : groups) {
+        bytes += sizeof(pair) + pair.first.capacity() + pair.second.states.capacity() * sizeof(AggregateState);
+        for (const auto& value : pair.second.key) {
+            bytes += sizeof(value) + value.capacity();
+        }
+        for (const auto& state : pair.second.states) {
+            for (const auto& entry : state.values) {
+                bytes += sizeof(entry) + entry.first.capacity();
+            }
+        }
+    }
+    return bytes;
+}
+
+std::string MaterializedView::definition(const std::string& table, const std::vector<std::string>& columns) const {
+    std::string text = "SELECT ";
+    for (int idx : group_columns) {
+        text += columns[idx] + ", ";
+    }
+    for (size_t i = 0; i < aggregates.size(); ++i) {
+        text += aggregates[i].function + "(" + (aggregates[i].column < 0 ? "*" : columns[aggregates[i].column]) + ")";
+        if (i != aggregates.size() - 1) text += ", ";
+    }
+    text += " FROM " + table;
+    if (!group_columns.empty()) {
+        text += " GROUP BY ";
+        for (size_t i = 0; i < group_columns.size(); ++i) {
+            text += columns[group_columns[i]];
+            if (i != group_columns.size() - 1) text += ", ";
+        }
+    }
+    return text;
+}
+
+void MaterializedView::print(const std::vector<std::string>& columns, std::ostream& out) const {
+    // Print header
+    for (size_t i = 0; i < group_columns.size(); ++i) {
+        out << std::left << std::setw(15) << columns[group_columns[i]];
+        if (i != group_columns.size() - 1 || !aggregates.empty()) out << " | ";
+    }
+    for (size_t i = 0; i < aggregates.size(); ++i) {
+        out << std::left << std::setw(15) << (aggregates[i].function + "(" +
+            (aggregates[i].column < 0 ? "*" : columns[aggregates[i].column]) + ")");
+        if (i != aggregates.size() - 1) out << " | ";
+    }
+    out << "\n";
+
+    // Print separator
+    for (size_t i = 0; i < group_columns.size() + aggregates.size(); ++i) {
+        out << "---------------";
+        if (i != group_columns.size() + aggregates.size() - 1) out << "+";
+    }
+    out << "\n";
+
+    for (const auto& pair : groups) {
+        const Group& group = pair.second;
+        for (size_t i = 0; i < group.key.size(); ++i) {
+            out << std::left << std::setw(15) << group.key[i];
+            if (i != group.key.size() - 1 || !aggregates.empty()) out << " | ";
+        }
+        for (size_t i = 0; i < aggregates.size(); ++i) {
+            const std::string& function = aggregates[i].function;
+            const AggregateState& state = group.states[i];
+            std::stringstream cell;
+            if (function == "COUNT") {
+                cell << (aggregates[i].column < 0 ? group.rows : state.count);
+            } else if (function == "SUM") {
+                if (state.fractional > 0 || state.overflowed) {
+                    cell << std::setprecision(15) << state.real_sum;
+                } else {
+                    cell << state.integer_sum;
+                }
+            } else if (!state.values.empty()) {
+                cell << (function == "MIN" ? state.values.begin()->first : state.values.rbegin()->first);
+            }
+            out << std::left << std::setw(15) << cell.str();
+            if (i != aggregates.size() - 1) out << " | ";
+        }
+        out << "\n";
+    }
+}
+
+std::string MaterializedView::serialize(const std::vector<std::string>& columns) const {
+    std::stringstream ss;
+    ss << name << " " << group_columns.size();
+    for (int idx : group_columns) {
+        ss << " " << columns[idx];
+    }
+    ss << " " << aggregates.size();
+    for (const auto& aggregate : aggregates) {
+        ss << " " << aggregate.function << " " << (aggregate.column < 0 ? "*" : columns[aggregate.column]);
+    }
+    return ss.str();
+}
+
+bool MaterializedView::deserialize(const std::string& line, const std::vector<std::string>& columns,
+                                   std::vector<MaterializedView>& views) {
+    std::stringstream ss(line);
+    auto column_index = [&](const std::string& column) -> int {
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (columns[i] == column) return static_cast<int>(i);
+        }
+        return -2;
+    };
+    std::string view_name, column;
+    size_t group_count = 0, aggregate_count = 0;
+    if (!(ss >> view_name >> group_count)) return false;
+    std::vector<int> group_columns;
+    for (size_t i = 0; i < group_count; ++i) {
+        if (!(ss >> column) || column_index(column) < 0) return false;
+        group_columns.push_back(column_index(column));
+    }
+    if (!(ss >> aggregate_count)) return false;
+    std::vector<ViewAggregate> aggregates;
+    for (size_t i = 0; i < aggregate_count; ++i) {
+        ViewAggregate aggregate;
+        if (!(ss >> aggregate.function >> column)) return false;
+        aggregate.column = column == "*" ? -1 : column_index(column);
+        if (aggregate.column == -2) return false;
+        aggregates.push_back(aggregate);
+    }
+    views.emplace_back(view_name, group_columns, aggregates);
+    return true;
+}
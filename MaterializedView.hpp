@@ -0,0 +1,73 @@
+// MaterializedView.hpp
+#ifndef MATERIALIZEDVIEW_HPP
+#define MATERIALIZEDVIEW_HPP
+
+#include "Record.hpp"
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+// One aggregate of a view: COUNT, SUM, MIN or MAX over a column (-1 for COUNT(*))
+struct ViewAggregate {
+    std::string function;
+    int column = -1;
+};
+
+// GROUP BY aggregate over one table, kept current row by row by the table's
+// insert, update and delete paths, so reading it costs O(groups).
+// Empty fields are nulls: COUNT(col), SUM, MIN and MAX skip them.
+// An integer SUM is kept modulo 2^64, so it is exact again once the true sum
+// is back in range; while it is out of range the REAL sum is printed instead.
+// Subtracting REAL values lets rounding drift until the next rebuild
+// (VACUUM, REFRESH).
+class MaterializedView {
+private:
+    struct AggregateState {
+        size_t count = 0;        // non-null values (rows for COUNT(*))
+        long long integer_sum = 0; // wraps modulo 2^64
+        bool overflowed = false;   // the true sum left the 64-bit range; print real_sum
+        double real_sum = 0.0;
+        size_t fractional = 0;   // summed values that are not integers
+        std::map<std::string, size_t, std::less<>> values; // MIN/MAX: value -> occurrences
+    };
+    struct Group {
+        std::vector<std::string> key;
+        size_t rows = 0;
+        std::vector<AggregateState> states;
+    };
+
+    std::string name;
+    std::vector<int> group_columns;
+    std::vector<ViewAggregate> aggregates;
+    std::map<std::string, Group> groups; // ordered like GROUP BY output
+    bool drifted = false; // REAL values were subtracted from a SUM
+
+    void apply(const Record& record, bool add);
+
+public:
+    MaterializedView(const std::string& name, const std::vector<int>& group_columns,
+                     const std::vector<ViewAggregate>& aggregates);
+
+    void addRow(const Record& record) { apply(record, true); }
+    void removeRow(const Record& record) { apply(record, false); }
+    void rebuild(const std::vector<const Record*>& rows);
+    bool hasDrifted() const { return drifted; }
+
+    const std::string& getName() const { return name; }
+    size_t groupCount() const { return groups.size(); }
+    // Approximate bytes held by the group states
+    size_t memoryBytes() const;
+    // The defining statement, e.g. "SELECT g, COUNT(*) FROM t GROUP BY g"
+    std::string definition(const std::string& table, const std::vector<std::string>& columns) const;
+    void print(const std::vector<std::string>& columns, std::ostream& out) const;
+
+    // One line of the table's .views file, and back
+    std::string serialize(const std::vector<std::string>& columns) const;
+    static bool deserialize(const std::string& line, const std::vector<std::string>& columns,
+                            std::vector<MaterializedView>& views);
+};
+
+#endif // MATERIALIZEDVIEW_HPP
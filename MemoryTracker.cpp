@@ -0,0 +1,90 @@
+// MemoryTracker.cpp
+#include "MemoryTracker.hpp"
+#include <algorithm>
+#include <sstream>
+
+MemoryTracker& MemoryTracker::instance() {
+    static MemoryTracker tracker;
+    return tracker;
+}
+
+bool MemoryTracker::hasRoom(size_t bytes) const {
+    size_t cap = limit;
+    return cap == 0 || totalBytes() + bytes <= cap;
+}
+
+void MemoryTracker::adjustTableBytes(size_t before, size_t after) {
+    if (after >= before) {
+        table_bytes += after - before;
+        return;
+    }
+    // Tables created or restored since the last sample are not in the total yet
+    size_t shrink = before - after;
+    size_t current = table_bytes.load();
+    while (!table_bytes.compare_exchange_weak(current, current - std::min(current, shrink))) {}
+}
+
+std::string MemoryTracker::describe() const {
+    std::ostringstream os;
+    os << "global memory limit (" << totalBytes() << " of " << getLimit() << " bytes in use)";
+    return os.str();
+}
+
+bool MemoryTracker::tryAdd(std::atomic<size_t>& counter, size_t bytes) {
+    size_t current = counter.load();
+    do {
+        size_t cap = limit;
+        // The other counters may move meanwhile; the cap is a soft bound across them
+        if (cap != 0 && totalBytes() - counter.load() + current + bytes > cap) {
+            return false;
+        }
+    } while (!counter.compare_exchange_weak(current, current + bytes));
+    return true;
+}
+
+QueryMemory::QueryMemory(QueryMemory&& other) noexcept
+    : limit(other.limit), used(other.used.exchange(0)), peak(other.peak.load()), owner(other.owner) {}
+
+QueryMemory::~QueryMemory() {
+    size_t held = used.exchange(0);
+    if (held > 0) {
+        MemoryTracker::instance().releaseQuery(held);
+    }
+}
+
+bool QueryMemory::reserve(size_t bytes) {
+    if (owner) return owner->reserve(bytes);
+    size_t current = used.load();
+    do {
+        if (limit != 0 && current + bytes > limit) {
+            return false;
+        }
+    } while (!used.compare_exchange_weak(current, current + bytes));
+    if (!MemoryTracker::instance().reserveQuery(bytes)) {
+        used -= bytes;
+        return false;
+    }
+    size_t now = current + bytes;
+    size_t highest = peak.load();
+    while (now > highest && !peak.compare_exchange_weak(highest, now)) {}
+    return true;
+}
+
+void QueryMemory::release(size_t bytes) {
+    if (owner) {
+        owner->release(bytes);
+        return;
+    }
+    used -= bytes;
+    MemoryTracker::instance().releaseQuery(bytes);
+}
+
+std::string QueryMemory::describeFailure(size_t bytes) const {
+    if (owner) return owner->describeFailure(bytes);
+    if (limit != 0 && used + bytes > limit) {
+        std::ostringstream os;
+        os << "query memory limit (" << used << " of " << limit << " bytes in use)";
+        return os.str();
+    }
+    return MemoryTracker::instance().describe();
+}
@@ -0,0 +1,81 @@
+// MemoryTracker.hpp
+#ifndef MEMORYTRACKER_HPP
+#define MEMORYTRACKER_HPP
+
+#include <atomic>
+#include <string>
+#include <cstddef>
+
+// Process-wide memory accounting against an optional global cap (0 = none).
+// Table bytes are adjusted by every write and resampled by
+// Database::publishTableMetrics; transaction backups and query operator
+// state are reserved before they are built.
+class MemoryTracker {
+private:
+    std::atomic<size_t> limit{0};
+    std::atomic<size_t> table_bytes{0};
+    std::atomic<size_t> transaction_bytes{0};
+    std::atomic<size_t> query_bytes{0};
+
+    MemoryTracker() = default;
+    // Add bytes to counter unless that would take the total over the cap
+    bool tryAdd(std::atomic<size_t>& counter, size_t bytes);
+
+public:
+    static MemoryTracker& instance();
+
+    void setLimit(size_t bytes) { limit = bytes; }
+    size_t getLimit() const { return limit; }
+    // Whether bytes more would still fit under the cap
+    bool hasRoom(size_t bytes) const;
+
+    void setTableBytes(size_t bytes) { table_bytes = bytes; }
+    // A write took one table from before to after bytes; the next sample replaces the total
+    void adjustTableBytes(size_t before, size_t after);
+    bool reserveTransaction(size_t bytes) { return tryAdd(transaction_bytes, bytes); }
+    void releaseTransaction(size_t bytes) { transaction_bytes -= bytes; }
+    bool reserveQuery(size_t bytes) { return tryAdd(query_bytes, bytes); }
+    void releaseQuery(size_t bytes) { query_bytes -= bytes; }
+
+    size_t tableBytes() const { return table_bytes; }
+    size_t transactionBytes() const { return transaction_bytes; }
+    size_t queryBytes() const { return query_bytes; }
+    size_t totalBytes() const { return table_bytes + transaction_bytes + query_bytes; }
+    // "global memory limit (900 of 1000 bytes in use)"
+    std::string describe() const;
+};
+
+// Operator memory of one statement. Each reservation counts against the
+// statement's limit (SET memory_limit, 0 = none) and the global cap, and
+// everything is returned when the statement ends. Thread-safe, so partition
+// workers can charge the statement that started them.
+class QueryMemory {
+private:
+    size_t limit = 0;
+    std::atomic<size_t> used{0};
+    std::atomic<size_t> peak{0};
+    QueryMemory* owner = nullptr;
+
+public:
+    QueryMemory() = default;
+    QueryMemory(QueryMemory&& other) noexcept;
+    QueryMemory(const QueryMemory&) = delete;
+    QueryMemory& operator=(const QueryMemory&) = delete;
+    ~QueryMemory();
+
+    void setLimit(size_t bytes) { limit = bytes; }
+    // Charge every reservation to the statement's budget instead
+    void chargeTo(QueryMemory& statement) { owner = &statement; }
+
+    // False, with nothing reserved, if a limit would be exceeded
+    bool reserve(size_t bytes);
+    void release(size_t bytes);
+    // The limit reserve(bytes) ran into, e.g. "query memory limit (900 of 1000 bytes in use)"
+    std::string describeFailure(size_t bytes) const;
+
+    size_t getLimit() const { return owner ? owner->getLimit() : limit; }
+    size_t bytesUsed() const { return owner ? owner->bytesUsed() : used.load(); }
+    size_t peakBytes() const { return owner ? owner->peakBytes() : peak.load(); }
+};
+
+#endif // MEMORYTRACKER_HPP
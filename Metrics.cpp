@@ -0,0 +1,206 @@
+// Metrics.cpp
+#include "Metrics.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+namespace {
+
+struct MetricInfo {
+    const char* name;
+    const char* labels; // empty if none
+    const char* help;
+};
+
+// Indexed by Counter; rows sharing a name are one Prometheus family
+const MetricInfo COUNTER_INFO[COUNTER_COUNT] = {
+    {"minidb_statements_total", "type=\"select\"", "Statements executed."},
+    {"minidb_statements_total", "type=\"insert\"", "Statements executed."},
+    {"minidb_statements_total", "type=\"update\"", "Statements executed."},
+    {"minidb_statements_total", "type=\"delete\"", "Statements executed."},
+    {"minidb_statements_total", "type=\"other\"", "Statements executed."},
+    {"minidb_rows_scanned_total", "", "Rows examined by table scans."},
+    {"minidb_rows_returned_total", "", "Rows returned by SELECT."},
+    {"minidb_rows_inserted_total", "", "Rows inserted."},
+    {"minidb_rows_updated_total", "", "Rows updated."},
+    {"minidb_rows_deleted_total", "", "Rows deleted."},
+    {"minidb_rows_vacuumed_total", "", "Tombstoned rows reclaimed by VACUUM."},
+    {"minidb_blocks_scanned_total", "", "Zone-map blocks scanned."},
+    {"minidb_blocks_skipped_total", "", "Zone-map blocks skipped by zone maps or Bloom filters."},
+    {"minidb_saves_total", "", "Table saves."},
+    {"minidb_save_bytes_total", "", "Bytes of table data written by saves."},
+    {"minidb_loads_total", "", "Table loads."},
+    {"minidb_transactions_total", "event=\"begin\"", "Transaction events."},
+    {"minidb_transactions_total", "event=\"commit\"", "Transaction events."},
+    {"minidb_transactions_total", "event=\"rollback\"", "Transaction events."},
+    {"minidb_result_cache_total", "event=\"hit\"", "Result cache lookups and removals."},
+    {"minidb_result_cache_total", "event=\"miss\"", "Result cache lookups and removals."},
+    {"minidb_result_cache_total", "event=\"invalidation\"", "Result cache lookups and removals."},
+    {"minidb_result_cache_total", "event=\"eviction\"", "Result cache lookups and removals."},
+    {"minidb_memory_limit_errors_total", "", "Statements stopped by a memory limit."},
+};
+
+const MetricInfo LATENCY_INFO[LATENCY_COUNT] = {
+    {"minidb_statement_duration_seconds", "", "Statement latency."},
+    {"minidb_save_duration_seconds", "", "Table save latency."},
+    {"minidb_load_duration_seconds", "", "Table load latency."},
+};
+
+// Prometheus bucket bounds in seconds
+const double LATENCY_BUCKETS[] = {0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1.0, 5.0};
+
+}
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+Metrics::~Metrics() {
+    stopDump();
+}
+
+Metrics::Shard& Metrics::localShard() {
+    // Hands the shard back when the thread exits, so short-lived worker and
+    // connection threads reuse shards instead of adding one each
+    struct Handle {
+        Metrics* owner = nullptr;
+        Shard* shard = nullptr;
+        ~Handle() {
+            if (shard) owner->releaseShard(shard);
+        }
+    };
+    thread_local Handle handle;
+    if (!handle.shard) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        if (!free_shards.empty()) {
+            handle.shard = free_shards.back();
+            free_shards.pop_back();
+        } else {
+            shards.push_back(std::make_unique<Shard>());
+            handle.shard = shards.back().get();
+        }
+        handle.owner = this;
+    }
+    return *handle.shard;
+}
+
+void Metrics::releaseShard(Shard* shard) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    free_shards.push_back(shard);
+}
+
+void Metrics::observe(Latency latency, uint64_t ns) {
+    Shard& shard = localShard();
+    std::lock_guard<std::mutex> lock(shard.histogram_mutex);
+    shard.latencies[static_cast<size_t>(latency)].record(ns);
+}
+
+void Metrics::setTableGauges(const std::map<std::string, TableGauges>& tables) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    table_gauges = tables;
+}
+
+MetricsSnapshot Metrics::snapshot() const {
+    MetricsSnapshot snap;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (const auto& shard : shards) {
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+            snap.counters[i] += shard->counters[i].load(std::memory_order_relaxed);
+        }
+        std::lock_guard<std::mutex> histogram_lock(shard->histogram_mutex);
+        for (size_t i = 0; i < LATENCY_COUNT; ++i) {
+            snap.latencies[i].merge(shard->latencies[i]);
+        }
+    }
+    snap.tables = table_gauges;
+    return snap;
+}
+
+void Metrics::writePrometheus(std::ostream& os) const {
+    MetricsSnapshot snap = snapshot();
+    const char* family = "";
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        const MetricInfo& info = COUNTER_INFO[i];
+        if (std::string(family) != info.name) {
+            family = info.name;
+            os << "# HELP " << info.name << " " << info.help << "\n";
+            os << "# TYPE " << info.name << " counter\n";
+        }
+        os << info.name;
+        if (*info.labels) os << "{" << info.labels << "}";
+        os << " " << snap.counters[i] << "\n";
+    }
+    for (size_t i = 0; i < LATENCY_COUNT; ++i) {
+        const MetricInfo& info = LATENCY_INFO[i];
+        const Histogram& h = snap.latencies[i];
+        os << "# HELP " << info.name << " " << info.help << "\n";
+        os << "# TYPE " << info.name << " histogram\n";
+        for (double bound : LATENCY_BUCKETS) {
+            os << info.name << "_bucket{le=\"" << bound << "\"} "
+               << h.countAtOrBelow(static_cast<uint64_t>(bound * 1e9)) << "\n";
+        }
+        os << info.name << "_bucket{le=\"+Inf\"} " << h.count() << "\n";
+        os << info.name << "_sum " << h.getSum() / 1e9 << "\n";
+        os << info.name << "_count " << h.count() << "\n";
+    }
+    const char* gauges[] = {"minidb_table_rows", "minidb_table_deleted_rows", "minidb_table_memory_bytes"};
+    const char* gauge_help[] = {"Live rows per table.", "Tombstoned rows awaiting VACUUM.",
+                                "Bytes held by the table's string pool and row arena."};
+    for (size_t g = 0; g < 3; ++g) {
+        os << "# HELP " << gauges[g] << " " << gauge_help[g] << "\n";
+        os << "# TYPE " << gauges[g] << " gauge\n";
+        for (const auto& pair : snap.tables) {
+            size_t value = g == 0 ? pair.second.rows : g == 1 ? pair.second.deleted_rows : pair.second.memory_bytes;
+            os << gauges[g] << "{table=\"" << pair.first << "\"} " << value << "\n";
+        }
+    }
+}
+
+bool Metrics::writePrometheusFile(const std::string& path) const {
+    // Write next to the target and rename, so a scraper never sees a partial file
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream ofs(tmp_path, std::ios::trunc);
+        if (!ofs) {
+            return false;
+        }
+        writePrometheus(ofs);
+        if (!ofs) {
+            return false;
+        }
+    }
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+bool Metrics::startDump(const std::string& path, double interval_seconds) {
+    stopDump();
+    if (!writePrometheusFile(path)) {
+        return false;
+    }
+    dump_path = path;
+    dump_stop = false;
+    auto interval = std::chrono::milliseconds(static_cast<long long>(interval_seconds * 1000));
+    dump_thread = std::thread(&Metrics::dumpLoop, this, interval);
+    return true;
+}
+
+void Metrics::dumpLoop(std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(dump_mutex);
+    while (!dump_cv.wait_for(lock, interval, [this] { return dump_stop; })) {
+        writePrometheusFile(dump_path);
+    }
+}
+
+void Metrics::stopDump() {
+    if (!dump_thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(dump_mutex);
+        dump_stop = true;
+    }
+    dump_cv.notify_all();
+    dump_thread.join();
+    writePrometheusFile(dump_path); // final values
+}
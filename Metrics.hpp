@@ -0,0 +1,136 @@
+// Metrics.hpp
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include "Histogram.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class Counter {
+    STATEMENTS_SELECT,
+    STATEMENTS_INSERT,
+    STATEMENTS_UPDATE,
+    STATEMENTS_DELETE,
+    STATEMENTS_OTHER,
+    ROWS_SCANNED,
+    ROWS_RETURNED,
+    ROWS_INSERTED,
+    ROWS_UPDATED,
+    ROWS_DELETED,
+    ROWS_VACUUMED,
+    BLOCKS_SCANNED,
+    BLOCKS_SKIPPED,
+    SAVES,
+    SAVE_BYTES,
+    LOADS,
+    TXN_BEGIN,
+    TXN_COMMIT,
+    TXN_ROLLBACK,
+    RESULT_CACHE_HITS,
+    RESULT_CACHE_MISSES,
+    RESULT_CACHE_INVALIDATIONS,
+    RESULT_CACHE_EVICTIONS,
+    MEMORY_LIMIT_ERRORS,
+    COUNT
+};
+
+// Latencies are recorded in nanoseconds
+enum class Latency {
+    STATEMENT,
+    SAVE,
+    LOAD,
+    COUNT
+};
+
+const size_t COUNTER_COUNT = static_cast<size_t>(Counter::COUNT);
+const size_t LATENCY_COUNT = static_cast<size_t>(Latency::COUNT);
+
+// Gauges published by Database for each table
+struct TableGauges {
+    size_t rows = 0;
+    size_t deleted_rows = 0;
+    size_t memory_bytes = 0;
+};
+
+struct MetricsSnapshot {
+    std::array<uint64_t, COUNTER_COUNT> counters{};
+    std::array<Histogram, LATENCY_COUNT> latencies;
+    std::map<std::string, TableGauges> tables;
+};
+
+// Process-wide registry. Each thread writes only its own shard, so the hot
+// path is an uncontended relaxed add; readers sum the shards.
+class Metrics {
+private:
+    struct Shard {
+        std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters;
+        std::mutex histogram_mutex; // only contended while a snapshot is taken
+        std::array<Histogram, LATENCY_COUNT> latencies;
+
+        Shard() {
+            for (auto& counter : counters) counter.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    mutable std::mutex registry_mutex;
+    std::vector<std::unique_ptr<Shard>> shards; // never shrinks; outlives its threads
+    std::vector<Shard*> free_shards;            // left by exited threads, keep their counts
+    std::map<std::string, TableGauges> table_gauges;
+
+    // Periodic Prometheus dump
+    std::thread dump_thread;
+    std::mutex dump_mutex;
+    std::condition_variable dump_cv;
+    bool dump_stop = false;
+    std::string dump_path;
+
+    Metrics() = default;
+    Shard& localShard();
+    void releaseShard(Shard* shard);
+    void dumpLoop(std::chrono::milliseconds interval);
+
+public:
+    static Metrics& instance();
+    ~Metrics();
+
+    void add(Counter counter, uint64_t n = 1) {
+        auto& value = localShard().counters[static_cast<size_t>(counter)];
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    void observe(Latency latency, uint64_t ns);
+    void setTableGauges(const std::map<std::string, TableGauges>& tables);
+
+    MetricsSnapshot snapshot() const;
+    void writePrometheus(std::ostream& os) const;
+    bool writePrometheusFile(const std::string& path) const;
+
+    // Rewrite path every interval until stopDump(); the file is replaced atomically
+    bool startDump(const std::string& path, double interval_seconds);
+    void stopDump();
+};
+
+// Records the time from construction to destruction into a latency histogram
+class ScopedLatency {
+private:
+    Latency latency;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedLatency(Latency latency) : latency(latency), start(std::chrono::steady_clock::now()) {}
+    ~ScopedLatency() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        Metrics::instance().observe(latency, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+};
+
+#endif // METRICS_HPP
@@ -0,0 +1,172 @@
+// PartitionSpec.cpp
+#include "PartitionSpec.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+
+bool parseNumber(std::string_view value, double& number) {
+    if (value.empty()) return false;
+    std::string text(value);
+    char* end = nullptr;
+    number = std::strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size();
+}
+
+// value < bound, numerically when both are numbers
+bool lessThan(std::string_view value, const std::string& bound) {
+    double a = 0.0, b = 0.0;
+    if (parseNumber(value, a) && parseNumber(bound, b)) {
+        return a < b;
+    }
+    return value < bound;
+}
+
+// FNV-1a: stable across builds, unlike std::hash, so persisted rows stay in place
+uint64_t fnv1a(std::string_view value) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : value) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+}
+
+PartitionSpec PartitionSpec::range(int column, const std::vector<std::string>& names, const std::vector<std::string>& bounds) {
+    PartitionSpec spec;
+    spec.method = PartitionMethod::RANGE;
+    spec.column = column;
+    spec.names = names;
+    spec.bounds = bounds;
+    return spec;
+}
+
+PartitionSpec PartitionSpec::hash(int column, size_t count) {
+    PartitionSpec spec;
+    spec.method = PartitionMethod::HASH;
+    spec.column = column;
+    for (size_t i = 0; i < count; ++i) {
+        spec.names.push_back("p" + std::to_string(i));
+    }
+    return spec;
+}
+
+std::string PartitionSpec::methodName() const {
+    return method == PartitionMethod::RANGE ? "RANGE" : method == PartitionMethod::HASH ? "HASH" : "NONE";
+}
+
+int PartitionSpec::find(const std::string& partition_name) const {
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == partition_name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+int PartitionSpec::route(std::string_view value) const {
+    if (method == PartitionMethod::HASH) {
+        return names.empty() ? -1 : static_cast<int>(fnv1a(value) % names.size());
+    }
+    // Bounds ascend, so the first bound above the value wins
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        if (bounds[i].empty() || lessThan(value, bounds[i])) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+std::vector<size_t> PartitionSpec::prune(int where_idx, const std::string& value) const {
+    std::vector<size_t> targets;
+    if (where_idx >= 0 && where_idx == column) {
+        int partition = route(value);
+        if (partition >= 0) targets.push_back(partition);
+        return targets;
+    }
+    for (size_t i = 0; i < names.size(); ++i) {
+        targets.push_back(i);
+    }
+    return targets;
+}
+
+std::string PartitionSpec::describe(size_t partition) const {
+    if (method == PartitionMethod::HASH) {
+        return "hash " + std::to_string(partition) + " of " + std::to_string(names.size());
+    }
+    return bounds[partition].empty() ? "< MAXVALUE" : "< " + bounds[partition];
+}
+
+bool PartitionSpec::addRange(const std::string& partition_name, const std::string& upper_bound, std::string& error) {
+    if (method != PartitionMethod::RANGE) {
+        error = "ADD PARTITION requires RANGE partitioning";
+        return false;
+    }
+    if (find(partition_name) >= 0) {
+        error = "Partition " + partition_name + " already exists";
+        return false;
+    }
+    if (!bounds.empty() && (bounds.back().empty() || (!upper_bound.empty() && !lessThan(bounds.back(), upper_bound)))) {
+        error = "New partition bound must be above the last partition's bound";
+        return false;
+    }
+    names.push_back(partition_name);
+    bounds.push_back(upper_bound);
+    return true;
+}
+
+void PartitionSpec::remove(size_t partition) {
+    names.erase(names.begin() + partition);
+    if (method == PartitionMethod::RANGE) {
+        bounds.erase(bounds.begin() + partition);
+    }
+}
+
+void PartitionSpec::write(std::ostream& os) const {
+    os << methodName() << " " << column << " " << names.size() << "\n";
+    for (size_t i = 0; i < names.size(); ++i) {
+        os << names[i];
+        if (method == PartitionMethod::RANGE) {
+            os << " " << (bounds[i].empty() ? 0 : 1) << " " << bounds[i];
+        }
+        os << "\n";
+    }
+}
+
+bool PartitionSpec::read(const std::string& marker_line, std::istream& is, size_t column_count) {
+    std::stringstream header(marker_line);
+    std::string marker, method_name;
+    size_t count = 0;
+    int col = -1;
+    if (!(header >> marker >> method_name >> col >> count) || col < 0 || static_cast<size_t>(col) >= column_count) {
+        return false;
+    }
+    PartitionSpec spec;
+    spec.method = method_name == "RANGE" ? PartitionMethod::RANGE
+                : method_name == "HASH" ? PartitionMethod::HASH : PartitionMethod::NONE;
+    if (spec.method == PartitionMethod::NONE) {
+        return false;
+    }
+    spec.column = col;
+    std::string line;
+    for (size_t i = 0; i < count; ++i) {
+        if (!std::getline(is, line)) return false;
+        std::stringstream ss(line);
+        std::string partition_name;
+        if (!(ss >> partition_name)) return false;
+        spec.names.push_back(partition_name);
+        if (spec.method == PartitionMethod::RANGE) {
+            int has_bound = 0;
+            if (!(ss >> has_bound)) return false;
+            std::string bound;
+            if (has_bound) {
+                ss.get(); // separator
+                std::getline(ss, bound);
+            }
+            spec.bounds.push_back(bound);
+        }
+    }
+    *this = spec;
+    return true;
+}
@@ -0,0 +1,58 @@
+// PartitionSpec.hpp
+#ifndef PARTITIONSPEC_HPP
+#define PARTITIONSPEC_HPP
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+enum class PartitionMethod {
+    NONE,
+    RANGE,
+    HASH
+};
+
+// How a table's rows are split into partitions by one column.
+// RANGE: partition i holds values below bounds[i] and not below bounds[i - 1];
+// an empty bound is MAXVALUE. Values compare as numbers when both sides are
+// numeric, as strings otherwise. HASH: partition = FNV-1a(value) % count.
+class PartitionSpec {
+private:
+    PartitionMethod method = PartitionMethod::NONE;
+    int column = -1;
+    std::vector<std::string> names;
+    std::vector<std::string> bounds; // RANGE only
+
+public:
+    PartitionSpec() = default;
+    static PartitionSpec range(int column, const std::vector<std::string>& names, const std::vector<std::string>& bounds);
+    static PartitionSpec hash(int column, size_t count);
+
+    bool isPartitioned() const { return method != PartitionMethod::NONE; }
+    PartitionMethod getMethod() const { return method; }
+    std::string methodName() const;
+    int getColumn() const { return column; }
+    size_t count() const { return names.size(); }
+    const std::string& name(size_t partition) const { return names[partition]; }
+    const std::string& bound(size_t partition) const { return bounds[partition]; }
+    int find(const std::string& partition_name) const;
+
+    // Partition a row with this value belongs to, or -1 if no partition covers it
+    int route(std::string_view value) const;
+    // Partitions a scan with WHERE where_idx == value must read (where_idx < 0: all)
+    std::vector<size_t> prune(int where_idx, const std::string& value) const;
+    // Describes partition i for DESCRIBE and EXPLAIN, e.g. "< 2024" or "hash 1 of 4"
+    std::string describe(size_t partition) const;
+
+    // RANGE only: append a partition above the current last bound
+    bool addRange(const std::string& partition_name, const std::string& upper_bound, std::string& error);
+    void remove(size_t partition);
+
+    // Spec lines of a partitioned table's .tbl file
+    void write(std::ostream& os) const;
+    bool read(const std::string& marker_line, std::istream& is, size_t column_count);
+};
+
+#endif // PARTITIONSPEC_HPP
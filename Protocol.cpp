@@ -0,0 +1,97 @@
+// Protocol.cpp
+#include "Protocol.hpp"
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+void putLength(std::string& buffer, uint32_t length) {
+    buffer += static_cast<char>((length >> 24) & 0xff);
+    buffer += static_cast<char>((length >> 16) & 0xff);
+    buffer += static_cast<char>((length >> 8) & 0xff);
+    buffer += static_cast<char>(length & 0xff);
+}
+
+uint32_t getLength(const char* bytes) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(bytes);
+    return (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8) | uint32_t(b[3]);
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        // MSG_NOSIGNAL: a vanished peer is an error return, not SIGPIPE
+        ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool readAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t got = read(fd, data, size);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (got == 0) {
+            return false;
+        }
+        data += got;
+        size -= got;
+    }
+    return true;
+}
+
+}
+
+bool writeFrame(int fd, const std::string& payload) {
+    if (payload.size() > MAX_FRAME_BYTES) {
+        return false;
+    }
+    std::string frame;
+    frame.reserve(4 + payload.size());
+    putLength(frame, payload.size());
+    frame += payload;
+    return writeAll(fd, frame.data(), frame.size());
+}
+
+bool readFrame(int fd, std::string& payload) {
+    char header[4];
+    if (!readAll(fd, header, sizeof(header))) {
+        return false;
+    }
+    uint32_t length = getLength(header);
+    if (length > MAX_FRAME_BYTES) {
+        return false;
+    }
+    payload.resize(length);
+    return length == 0 || readAll(fd, &payload[0], length);
+}
+
+std::string encodeResponse(const std::string& output, const std::string& error) {
+    std::string payload;
+    payload.reserve(4 + output.size() + error.size());
+    putLength(payload, output.size());
+    payload += output;
+    payload += error;
+    return payload;
+}
+
+bool decodeResponse(const std::string& payload, std::string& output, std::string& error) {
+    if (payload.size() < 4) {
+        return false;
+    }
+    uint32_t output_length = getLength(payload.data());
+    if (output_length > payload.size() - 4) {
+        return false;
+    }
+    output = payload.substr(4, output_length);
+    error = payload.substr(4 + output_length);
+    return true;
+}
@@ -0,0 +1,21 @@
+// Protocol.hpp
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <cstdint>
+#include <string>
+
+// Wire format shared by Server and Client. Every message is a frame: a 4-byte
+// big-endian payload length followed by the payload.
+//   request payload:  one statement
+//   response payload: 4-byte big-endian output length, output text, error text
+const uint32_t MAX_FRAME_BYTES = 64u << 20;
+
+bool writeFrame(int fd, const std::string& payload);
+// False on EOF, I/O error or an oversized frame
+bool readFrame(int fd, std::string& payload);
+
+std::string encodeResponse(const std::string& output, const std::string& error);
+bool decodeResponse(const std::string& payload, std::string& output, std::string& error);
+
+#endif // PROTOCOL_HPP
@@ -0,0 +1,22 @@
+// QueryContext.hpp
+#ifndef QUERYCONTEXT_HPP
+#define QUERYCONTEXT_HPP
+
+#include "QueryStats.hpp"
+#include "MemoryTracker.hpp"
+#include <iostream>
+
+// Where one statement writes its results and errors, plus its counters
+// and memory budget. Each concurrent caller passes its own context.
+struct QueryContext {
+    std::ostream* out = &std::cout;
+    std::ostream* err = &std::cerr;
+    QueryStats stats;
+    QueryMemory memory;
+    bool in_transaction = false; // writes are saved at COMMIT, not per statement
+
+    QueryContext() = default;
+    QueryContext(std::ostream& out, std::ostream& err) : out(&out), err(&err) {}
+};
+
+#endif // QUERYCONTEXT_HPP
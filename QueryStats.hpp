@@ -0,0 +1,40 @@
+// QueryStats.hpp
+#ifndef QUERYSTATS_HPP
+#define QUERYSTATS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using StageClock = std::chrono::steady_clock;
+
+// One step of a statement as reported by EXPLAIN ANALYZE
+struct StageStats {
+    std::string name;
+    double ms = 0.0;
+    size_t rows_in = 0;
+    size_t rows_out = 0;
+    size_t bytes_allocated = 0; // memory held by the stage's output
+    size_t io_bytes = 0;        // bytes read from or written to disk
+};
+
+// Per-statement counters filled in by Table scans
+struct QueryStats {
+    size_t blocks_scanned = 0;
+    size_t blocks_skipped = 0;
+    size_t bloom_skipped = 0; // subset of blocks_skipped ruled out by Bloom filters
+    size_t partitions_scanned = 0;
+    size_t partitions_pruned = 0;
+    bool profile = false;     // record stages (EXPLAIN ANALYZE)
+    std::vector<StageStats> stages;
+
+    void addStage(const std::string& name, StageClock::time_point start, size_t rows_in, size_t rows_out,
+                  size_t bytes_allocated = 0, size_t io_bytes = 0) {
+        if (!profile) return;
+        double ms = std::chrono::duration<double, std::milli>(StageClock::now() - start).count();
+        stages.push_back({name, ms, rows_in, rows_out, bytes_allocated, io_bytes});
+    }
+};
+
+#endif // QUERYSTATS_HPP
@@ -1,3 +1,3 @@
-// Record.cpp
-#include "Record.hpp"
+// Record.cpp
+#include "Record.hpp"
 // Currently empty as we use default implementations
\ No newline at end of file
@@ -1,16 +1,21 @@
-// Record.hpp
-#ifndef RECORD_HPP
-#define RECORD_HPP
-
-#include <vector>
-#include <string>
-
-class Record {
-public:
-    std::vector<std::string> fields;
-
-    Record() = default;
-    Record(const std::vector<std::string>& fields) : fields(fields) {}
-};
-
-#endif // RECORD_HPP
\ No newline at end of file
+// Record.hpp
+#ifndef RECORD_HPP
+#define RECORD_HPP
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory_resource>
+
+class Record {
+public:
+    // Views into the owning table's StringPool; the array itself lives in
+    // the table's row arena (or the default heap for query-local copies)
+    std::pmr::vector<std::string_view> fields;
+
+    Record() = default;
+    Record(const Record& other, std::pmr::memory_resource* resource) : fields(other.fields, resource) {}
+    explicit Record(std::pmr::vector<std::string_view> fields) : fields(std::move(fields)) {}
+};
+
+#endif // RECORD_HPP
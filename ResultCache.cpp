@@ -0,0 +1,136 @@
+// ResultCache.cpp
+#include "ResultCache.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+// Per-entry bookkeeping on top of the strings: list node, index node, iterator
+const size_t ENTRY_OVERHEAD = 128;
+
+bool isKeyword(std::string word) {
+    std::transform(word.begin(), word.end(), word.begin(), ::toupper);
+    static const char* keywords[] = {"SELECT", "FROM", "WHERE", "ORDER", "GROUP", "BY", "ASC", "DESC"};
+    for (const char* keyword : keywords) {
+        if (word == keyword) return true;
+    }
+    return false;
+}
+
+}
+
+std::string ResultCache::normalize(const std::string& statement) {
+    // Split into words on whitespace outside quotes
+    std::vector<std::string> words;
+    std::string word;
+    bool in_quotes = false;
+    for (char c : statement) {
+        if (c == '\'') in_quotes = !in_quotes;
+        if (!in_quotes && std::isspace(static_cast<unsigned char>(c))) {
+            if (!word.empty()) words.push_back(std::move(word));
+            word.clear();
+        } else {
+            word += c;
+        }
+    }
+    if (!word.empty()) words.push_back(std::move(word));
+    if (!words.empty() && words.back().back() == ';') {
+        words.back().pop_back();
+        if (words.back().empty()) words.pop_back();
+    }
+
+    std::string normalized;
+    for (auto& w : words) {
+        size_t paren = w.find('(');
+        if (isKeyword(w)) {
+            std::transform(w.begin(), w.end(), w.begin(), ::toupper);
+        } else if (paren != std::string::npos && w.front() != '\'') {
+            // Aggregate function names are case-insensitive, their arguments are not
+            std::transform(w.begin(), w.begin() + paren, w.begin(), ::toupper);
+        }
+        if (!normalized.empty()) normalized += ' ';
+        normalized += w;
+    }
+    return normalized;
+}
+
+void ResultCache::erase(std::list<Entry>::iterator it) {
+    used_bytes -= it->bytes;
+    index.erase(it->key);
+    lru.erase(it);
+}
+
+void ResultCache::evictTo(size_t bytes) {
+    while (used_bytes > bytes && !lru.empty()) {
+        erase(std::prev(lru.end()));
+        Metrics::instance().add(Counter::RESULT_CACHE_EVICTIONS);
+    }
+}
+
+bool ResultCache::lookup(const std::string& key, const std::string& table, uint64_t version, std::string& output) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = index.find(key);
+    if (found == index.end()) {
+        Metrics::instance().add(Counter::RESULT_CACHE_MISSES);
+        return false;
+    }
+    auto it = found->second;
+    if (it->table != table || it->version != version) {
+        // The table changed since the entry was computed
+        erase(it);
+        Metrics::instance().add(Counter::RESULT_CACHE_INVALIDATIONS);
+        Metrics::instance().add(Counter::RESULT_CACHE_MISSES);
+        return false;
+    }
+    lru.splice(lru.begin(), lru, it);
+    output = it->output;
+    Metrics::instance().add(Counter::RESULT_CACHE_HITS);
+    return true;
+}
+
+void ResultCache::store(const std::string& key, const std::string& table, uint64_t version, const std::string& output) {
+    size_t bytes = key.size() + table.size() + output.size() + ENTRY_OVERHEAD;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = index.find(key);
+    if (found != index.end()) {
+        erase(found->second);
+    }
+    if (bytes > capacity_bytes) {
+        return; // would evict everything else and still not fit
+    }
+    evictTo(capacity_bytes - bytes);
+    lru.push_front(Entry{key, table, version, output, bytes});
+    index[key] = lru.begin();
+    used_bytes += bytes;
+}
+
+void ResultCache::setCapacity(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity_bytes = bytes;
+    evictTo(capacity_bytes);
+}
+
+void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    lru.clear();
+    index.clear();
+    used_bytes = 0;
+}
+
+size_t ResultCache::capacity() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return capacity_bytes;
+}
+
+size_t ResultCache::bytesUsed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used_bytes;
+}
+
+size_t ResultCache::entryCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lru.size();
+}
@@ -0,0 +1,53 @@
+// ResultCache.hpp
+#ifndef RESULTCACHE_HPP
+#define RESULTCACHE_HPP
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+
+const size_t DEFAULT_RESULT_CACHE_BYTES = 16 * 1024 * 1024;
+
+// Printed output of SELECT statements, keyed by normalized statement text.
+// An entry is only served while its table still has the version it was
+// computed at; stale entries are dropped on lookup. Least recently used
+// entries are evicted to stay under the byte cap. Thread-safe.
+class ResultCache {
+private:
+    struct Entry {
+        std::string key;
+        std::string table;
+        uint64_t version = 0;
+        std::string output;
+        size_t bytes = 0;
+    };
+
+    mutable std::mutex mutex;
+    size_t capacity_bytes;
+    size_t used_bytes = 0;
+    std::list<Entry> lru; // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+    void erase(std::list<Entry>::iterator it);
+    void evictTo(size_t bytes);
+
+public:
+    explicit ResultCache(size_t capacity_bytes = DEFAULT_RESULT_CACHE_BYTES) : capacity_bytes(capacity_bytes) {}
+
+    // Collapse whitespace and keyword case outside quotes, drop a trailing ';'
+    static std::string normalize(const std::string& statement);
+
+    bool lookup(const std::string& key, const std::string& table, uint64_t version, std::string& output);
+    void store(const std::string& key, const std::string& table, uint64_t version, const std::string& output);
+    void setCapacity(size_t bytes);
+    void clear();
+
+    size_t capacity() const;
+    size_t bytesUsed() const;
+    size_t entryCount() const;
+};
+
+#endif // RESULTCACHE_HPP
@@ -0,0 +1,153 @@
+// RowSorter.cpp
+#include "RowSorter.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+struct Entry {
+    uint64_t key;
+    size_t row;
+};
+
+using Runs = std::vector<std::pair<size_t, size_t>>;
+
+// First 8 bytes, big-endian and zero padded, so keys order like the values.
+// exact is cleared when a key no longer decides its value's order.
+uint64_t normalizedKey(std::string_view value, bool descending, bool& exact) {
+    uint64_t key = 0;
+    size_t length = std::min<size_t>(value.size(), 8);
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char c = value[i];
+        if (c == 0) exact = false; // "a" and "a\0" share a key
+        key |= uint64_t(c) << (56 - 8 * i);
+    }
+    if (value.size() > 8) exact = false;
+    return descending ? ~key : key;
+}
+
+// LSD radix sort, one byte per pass; a pass is skipped when all keys share that byte
+void radixSort(std::vector<Entry>& entries) {
+    std::vector<Entry> buffer(entries.size());
+    for (unsigned shift = 0; shift < 64; shift += 8) {
+        std::array<size_t, 256> counts{};
+        for (const auto& entry : entries) {
+            counts[(entry.key >> shift) & 0xFF]++;
+        }
+        if (counts[(entries[0].key >> shift) & 0xFF] == entries.size()) continue;
+        size_t offset = 0;
+        for (auto& count : counts) {
+            size_t bucket = count;
+            count = offset;
+            offset += bucket;
+        }
+        for (const auto& entry : entries) {
+            buffer[counts[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        entries.swap(buffer);
+    }
+}
+
+// Three-way compare on the keys with every direction fixed at compile time
+template <bool Descending, bool... Rest>
+int compareKeys(const Record& a, const Record& b, const int* columns) {
+    int c = a.fields[*columns].compare(b.fields[*columns]);
+    if (c != 0) return Descending ? -c : c;
+    if constexpr (sizeof...(Rest) > 0) {
+        return compareKeys<Rest...>(a, b, columns + 1);
+    } else {
+        return 0;
+    }
+}
+
+template <typename Less>
+void sortRuns(std::vector<Entry>& entries, const Runs& runs, Less less) {
+    for (const auto& run : runs) {
+        std::stable_sort(entries.begin() + run.first, entries.begin() + run.second,
+                         [&](const Entry& a, const Entry& b) { return less(a.row, b.row); });
+    }
+}
+
+// Moves one key's direction at a time into the template arguments, then
+// sorts with the comparator built for exactly those keys
+template <bool... Descending>
+void sortRunsSpecialized(const std::vector<const Record*>& rows, const std::vector<SortKey>& keys,
+                         std::vector<Entry>& entries, const Runs& runs) {
+    constexpr size_t resolved = sizeof...(Descending);
+    if constexpr (resolved < MAX_SPECIALIZED_SORT_KEYS) {
+        if (resolved < keys.size()) {
+            if (keys[resolved].descending) {
+                sortRunsSpecialized<Descending..., true>(rows, keys, entries, runs);
+            } else {
+                sortRunsSpecialized<Descending..., false>(rows, keys, entries, runs);
+            }
+            return;
+        }
+    }
+    if constexpr (resolved > 0) {
+        std::array<int, resolved> columns;
+        for (size_t i = 0; i < resolved; ++i) {
+            columns[i] = keys[i].column;
+        }
+        sortRuns(entries, runs, [&](size_t a, size_t b) {
+            return compareKeys<Descending...>(*rows[a], *rows[b], columns.data()) < 0;
+        });
+    }
+}
+
+}
+
+size_t RowSorter::workingBytes(size_t rows) {
+    // Entries and the radix buffer, the permutation, the reordered pointers
+    return rows * (2 * sizeof(Entry) + sizeof(size_t) + sizeof(const Record*));
+}
+
+std::vector<size_t> RowSorter::order(const std::vector<const Record*>& rows, const std::vector<SortKey>& keys,
+                                     bool* radix_used) {
+    std::vector<Entry> entries(rows.size());
+    bool exact = true;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        entries[i].key = keys.empty() ? 0 : normalizedKey(rows[i]->fields[keys[0].column], keys[0].descending, exact);
+        entries[i].row = i;
+    }
+    bool radix = !keys.empty() && entries.size() >= RADIX_SORT_MIN_ROWS;
+    if (radix) {
+        radixSort(entries);
+    } else if (!keys.empty()) {
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const Entry& a, const Entry& b) { return a.key < b.key; });
+    }
+    if (radix_used) *radix_used = radix;
+
+    // Only runs the normalized key leaves tied need a comparator
+    if (!keys.empty() && (!exact || keys.size() > 1)) {
+        Runs runs;
+        for (size_t begin = 0; begin < entries.size();) {
+            size_t end = begin + 1;
+            while (end < entries.size() && entries[end].key == entries[begin].key) end++;
+            if (end - begin > 1) runs.emplace_back(begin, end);
+            begin = end;
+        }
+        if (keys.size() <= MAX_SPECIALIZED_SORT_KEYS) {
+            sortRunsSpecialized<>(rows, keys, entries, runs);
+        } else {
+            sortRuns(entries, runs, [&](size_t a, size_t b) {
+                for (const auto& key : keys) {
+                    int c = rows[a]->fields[key.column].compare(rows[b]->fields[key.column]);
+                    if (c != 0) return key.descending ? c > 0 : c < 0;
+                }
+                return false;
+            });
+        }
+    }
+
+    std::vector<size_t> permutation;
+    permutation.reserve(entries.size());
+    for (const auto& entry : entries) {
+        permutation.push_back(entry.row);
+    }
+    return permutation;
+}
@@ -0,0 +1,36 @@
+// RowSorter.hpp
+#ifndef ROWSORTER_HPP
+#define ROWSORTER_HPP
+
+#include "Record.hpp"
+#include <vector>
+#include <cstddef>
+
+// Up to this many ORDER BY keys get a comparator compiled for their directions
+const size_t MAX_SPECIALIZED_SORT_KEYS = 3;
+// Below this many rows a comparison sort on the normalized keys beats radix passes
+const size_t RADIX_SORT_MIN_ROWS = 256;
+
+struct SortKey {
+    int column = 0;
+    bool descending = false;
+};
+
+// ORDER BY kernel. Sorts a permutation of row positions, never the rows.
+// The first key is packed into an 8-byte normalized key (big-endian prefix,
+// inverted for DESC) and radix sorted; runs with equal normalized keys are
+// then ordered by a comparator over the full keys. When every value of the
+// first key fits in 8 bytes the normalized key is exact, so with a single
+// key no comparator runs at all. Values compare as byte strings, as
+// everywhere else in the engine. The sort is stable.
+class RowSorter {
+public:
+    // Positions into rows in sorted order; radix_used reports whether
+    // radix passes ran (false for small inputs)
+    static std::vector<size_t> order(const std::vector<const Record*>& rows, const std::vector<SortKey>& keys,
+                                     bool* radix_used = nullptr);
+    // Upper bound on what order() allocates for this many rows, plus the reordered pointer array
+    static size_t workingBytes(size_t rows);
+};
+
+#endif // ROWSORTER_HPP
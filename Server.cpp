@@ -0,0 +1,115 @@
+// Server.cpp
+#include "Server.hpp"
+#include "Protocol.hpp"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// How often the accept loop wakes up to check for shutdown and refresh table gauges.
+// The refresh never waits: tables an open transaction holds keep their last gauges.
+const int ACCEPT_POLL_MS = 500;
+
+Server::Server(Database& db, const std::string& socket_path) : db(db), socket_path(socket_path) {}
+
+Server::~Server() {
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        unlink(socket_path.c_str());
+    }
+}
+
+bool Server::start(std::ostream& err) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        err << "Error: Socket path " << socket_path << " is too long.\n";
+        return false;
+    }
+    std::strcpy(addr.sun_path, socket_path.c_str());
+
+    // Replace a stale socket left by a previous run, but never a regular file
+    struct stat st;
+    if (stat(socket_path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            err << "Error: " << socket_path << " exists and is not a socket.\n";
+            return false;
+        }
+        unlink(socket_path.c_str());
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        err << "Error: Unable to create socket: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listen_fd, 64) < 0) {
+        err << "Error: Unable to listen on " << socket_path << ": " << std::strerror(errno) << "\n";
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+void Server::run() {
+    while (!stopping.load()) {
+        pollfd pfd{listen_fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, ACCEPT_POLL_MS);
+        if (ready <= 0) {
+            db.publishTableMetrics(nullptr, false);
+            continue; // timeout or EINTR
+        }
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            client_fds.insert(fd);
+        }
+        std::thread(&Server::serveClient, this, fd).detach();
+    }
+
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(socket_path.c_str());
+
+    // Wake sessions blocked in read(); each one rolls back and unregisters itself
+    std::unique_lock<std::mutex> lock(clients_mutex);
+    for (int fd : client_fds) {
+        shutdown(fd, SHUT_RDWR);
+    }
+    clients_done.wait(lock, [this] { return client_fds.empty(); });
+}
+
+void Server::serveClient(int fd) {
+    std::ostringstream out, err;
+    Session session(out, err);
+    std::string statement;
+    while (readFrame(fd, statement)) {
+        if (statement == "exit") {
+            break;
+        }
+        out.str("");
+        err.str("");
+        db.execute(statement, session);
+        if (!writeFrame(fd, encodeResponse(out.str(), err.str()))) {
+            break;
+        }
+    }
+    // A transaction the client left open is rolled back
+    db.endSession(session);
+
+    // Close under the lock so run() never shuts down a reused descriptor
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    client_fds.erase(fd);
+    close(fd);
+    clients_done.notify_all();
+}
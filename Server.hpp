@@ -0,0 +1,39 @@
+// Server.hpp
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "Database.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+
+// Serves one Database over a Unix domain socket, one thread and one
+// Session per connection. Each request frame is one statement; the
+// response carries its output and error text (see Protocol.hpp).
+class Server {
+private:
+    Database& db;
+    std::string socket_path;
+    int listen_fd = -1;
+    std::atomic<bool> stopping{false};
+
+    std::mutex clients_mutex;
+    std::condition_variable clients_done;
+    std::set<int> client_fds; // open connections, shut down on stop
+
+    void serveClient(int fd);
+
+public:
+    Server(Database& db, const std::string& socket_path);
+    ~Server();
+
+    bool start(std::ostream& err);
+    // Accept connections until requestStop(), then close them and wait for their sessions
+    void run();
+    // Async-signal-safe
+    void requestStop() { stopping.store(true); }
+};
+
+#endif // SERVER_HPP
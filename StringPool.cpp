@@ -0,0 +1,62 @@
+// StringPool.cpp
+#include "StringPool.hpp"
+#include <cstring>
+
+uint32_t& StringPool::references(std::string_view stored) {
+    // The count sits in the arena right before the value's bytes
+    return *reinterpret_cast<uint32_t*>(const_cast<char*>(stored.data()) - sizeof(uint32_t));
+}
+
+std::string_view StringPool::intern(std::string_view value) {
+    lookups++;
+    if (value.empty()) {
+        return std::string_view();
+    }
+    auto it = interned.find(value);
+    if (it != interned.end()) {
+        retain(*it);
+        return *it;
+    }
+    char* data = static_cast<char*>(arena.allocate(sizeof(uint32_t) + value.size(), alignof(uint32_t)));
+    std::memcpy(data + sizeof(uint32_t), value.data(), value.size());
+    std::string_view stored(data + sizeof(uint32_t), value.size());
+    references(stored) = 1;
+    interned.insert(stored);
+    value_bytes += value.size();
+    return stored;
+}
+
+void StringPool::retain(std::string_view stored) {
+    if (stored.empty()) return;
+    if (references(stored)++ == 0) {
+        unreferenced_values--;
+        unreferenced_bytes -= stored.size();
+    }
+}
+
+void StringPool::release(std::string_view stored) {
+    if (stored.empty()) return;
+    if (--references(stored) == 0) {
+        unreferenced_values++;
+        unreferenced_bytes += stored.size();
+    }
+}
+
+void StringPool::clearReferences() {
+    for (std::string_view stored : interned) {
+        references(stored) = 0;
+    }
+    unreferenced_values = interned.size();
+    unreferenced_bytes = value_bytes;
+}
+
+bool StringPool::worthRebuilding() const {
+    return unreferenced_bytes > 0 && unreferenced_bytes >= value_bytes * POOL_REBUILD_UNREFERENCED_FRACTION;
+}
+
+size_t StringPool::bytesReserved() const {
+    // Arena chunks plus an estimate of the hash set's nodes and buckets
+    return arena.bytesReserved() +
+           interned.size() * (sizeof(std::string_view) + 2 * sizeof(void*)) +
+           interned.bucket_count() * sizeof(void*);
+}
@@ -0,0 +1,52 @@
+// StringPool.hpp
+#ifndef STRINGPOOL_HPP
+#define STRINGPOOL_HPP
+
+#include "Arena.hpp"
+#include <cstdint>
+#include <string_view>
+#include <unordered_set>
+#include <cstddef>
+
+// Rebuild a pool once unreferenced bytes reach this fraction of its values
+const double POOL_REBUILD_UNREFERENCED_FRACTION = 0.25;
+
+// Deduplicated, append-only storage for field values. Every distinct value
+// is copied into the arena once, behind a count of the rows referencing it;
+// callers hold string_views into it, which stay valid for the lifetime of
+// the pool. Values no row references are only counted, and reclaimed by
+// building a new pool from the live rows.
+class StringPool {
+private:
+    Arena arena;
+    std::unordered_set<std::string_view> interned;
+    size_t lookups = 0;
+    size_t value_bytes = 0;
+    size_t unreferenced_values = 0;
+    size_t unreferenced_bytes = 0;
+
+    static uint32_t& references(std::string_view stored);
+
+public:
+    StringPool() = default;
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    // Stored copy of value, with one more reference
+    std::string_view intern(std::string_view value);
+    // One more reference to a view returned by intern
+    void retain(std::string_view stored);
+    // A row no longer references stored (overwritten or deleted)
+    void release(std::string_view stored);
+    // Drop every reference, for a caller that retains the values its rows hold
+    void clearReferences();
+    bool worthRebuilding() const;
+
+    size_t distinctCount() const { return interned.size(); }
+    size_t lookupCount() const { return lookups; }
+    size_t unreferencedCount() const { return unreferenced_values; }
+    size_t unreferencedBytes() const { return unreferenced_bytes; }
+    size_t bytesReserved() const;
+};
+
+#endif // STRINGPOOL_HPP
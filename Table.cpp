@@ -1,451 +1,1689 @@
-// Table.cpp
-#include "Table.hpp"
-#include <sstream>
-#include <algorithm>
-#include <map>
-#include <iomanip>
-
-// Initialize DATA_DIR as a constant
-const std::string DATA_DIR = "data/";
-
-Table::Table(const std::string& name, const std::vector<std::string>& columns) : name(name), columns(columns) {
-    filepath = DATA_DIR + name + ".tbl";
-    save(); // Save table schema
-}
-
-Table::Table(const std::string& name) : name(name) {
-    filepath = DATA_DIR + name + ".tbl";
-    load();
-}
-
-void Table::insert(const std::vector<std::string>& fields) {
-    if (fields.size() != columns.size()) {
-        std::cerr << "Error: Field count doesn't match column count.\n";
-        return;
-    }
-    records.emplace_back(fields);
-}
-
-void Table::select(const std::vector<std::string>& select_columns, 
-                  const std::vector<std::pair<std::string, std::string>>& aggregates,
-                  const std::string& where_column, 
-                  const std::string& where_value,
-                  const std::vector<std::pair<std::string, std::string>>& order_by,
-                  const std::vector<std::string>& group_by) {
-    // Determine columns to display
-    std::vector<int> col_indices;
-    // If selected_columns is empty (SELECT *), use all columns
-    if (select_columns.empty()) {
-        col_indices.resize(columns.size());
-        for (size_t i = 0; i < columns.size(); ++i) {
-            col_indices[i] = i;
-        }
-    } else {
-        for (const auto& col : select_columns) {
-            auto it = std::find(columns.begin(), columns.end(), col);
-            if (it != columns.end()) {
-                col_indices.push_back(std::distance(columns.begin(), it));
-            } else {
-                std::cerr << "Error: Column " << col << " does not exist.\n";
-                return;
-            }
-        }
-    }
-
-    // Handle GROUP BY
-    if (!group_by.empty()) {
-        // Ensure all group_by columns exist
-        std::vector<int> group_indices;
-        for (const auto& gb_col : group_by) {
-            auto it = std::find(columns.begin(), columns.end(), gb_col);
-            if (it != columns.end()) {
-                group_indices.push_back(std::distance(columns.begin(), it));
-            } else {
-                std::cerr << "Error: GROUP BY column " << gb_col << " does not exist.\n";
-                return;
-            }
-        }
-
-        // Prepare aggregate functions
-        std::vector<std::pair<std::string, int>> agg_functions; // function name and column index (-1 for COUNT(*))
-        for (const auto& agg : aggregates) {
-            std::string func = agg.first;
-            std::string target = agg.second;
-            std::transform(func.begin(), func.end(), func.begin(), ::toupper);
-            if (func == "COUNT") {
-                if (target == "*" ) {
-                    agg_functions.emplace_back(func, -1);
-                } else {
-                    auto it = std::find(columns.begin(), columns.end(), target);
-                    if (it != columns.end()) {
-                        agg_functions.emplace_back(func, std::distance(columns.begin(), it));
-                    } else {
-                        std::cerr << "Error: COUNT target column " << target << " does not exist.\n";
-                        return;
-                    }
-                }
-            }
-            else {
-                std::cerr << "Error: Unsupported aggregate function '" << func << "'.\n";
-                return;
-            }
-        }
-
-        // Group records
-        std::map<std::string, std::vector<Record>> grouped_records;
-        for (const auto& record : records) {
-            bool match = true;
-            if (!where_column.empty()) {
-                auto it = std::find(columns.begin(), columns.end(), where_column);
-                if (it != columns.end()) {
-                    int idx = std::distance(columns.begin(), it);
-                    if (record.fields[idx] != where_value) {
-                        match = false;
-                    }
-                } else {
-                    std::cerr << "Error: WHERE column " << where_column << " does not exist.\n";
-                    return;
-                }
-            }
-            if (match) {
-                std::string key;
-                for (const auto& idx : group_indices) {
-                    key += record.fields[idx] + "_";
-                }
-                grouped_records[key].emplace_back(record);
-            }
-        }
-
-        // Print header
-        for (size_t i = 0; i < group_by.size(); ++i) {
-            std::cout << std::left << std::setw(15) << group_by[i];
-            if (i != group_by.size() - 1 || !agg_functions.empty()) std::cout << " | ";
-        }
-        for (size_t i = 0; i < agg_functions.size(); ++i) {
-            std::cout << std::left << std::setw(15) << (agg_functions[i].second == -1 ? "COUNT(*)" : "COUNT(" + columns[agg_functions[i].second] + ")");
-            if (i != agg_functions.size() - 1) std::cout << " | ";
-        }
-        std::cout << "\n";
-
-        // Print separator
-        for (size_t i = 0; i < group_by.size(); ++i) {
-            std::cout << "---------------";
-            if (i != group_by.size() - 1 || !agg_functions.empty()) std::cout << "+";
-        }
-        for (size_t i = 0; i < agg_functions.size(); ++i) {
-            std::cout << "---------------";
-            if (i != agg_functions.size() - 1) std::cout << "+";
-        }
-        std::cout << "\n";
-
-        // Print grouped records with aggregates
-        for (const auto& pair : grouped_records) {
-            std::stringstream ss(pair.first);
-            std::string value;
-            size_t idx = 0;
-            while (std::getline(ss, value, '_')) {
-                if (idx < group_by.size()) {
-                    std::cout << std::left << std::setw(15) << value;
-                    if (idx != group_by.size() - 1 || !agg_functions.empty()) std::cout << " | ";
-                }
-                idx++;
-            }
-            for (size_t i = 0; i < agg_functions.size(); ++i) {
-                if (agg_functions[i].first == "COUNT") {
-                    if (agg_functions[i].second == -1) {
-                        std::cout << std::left << std::setw(15) << pair.second.size();
-                    }
-                    else {
-                        // Count non-empty values in the specified column
-                        int count = 0;
-                        for (const auto& rec : pair.second) {
-                            if (!rec.fields[agg_functions[i].second].empty()) {
-                                count++;
-                            }
-                        }
-                        std::cout << std::left << std::setw(15) << count;
-                    }
-                }
-                if (i != agg_functions.size() - 1) std::cout << " | ";
-            }
-            std::cout << "\n";
-        }
-        return;
-    }
-
-    // Filter records based on WHERE clause
-    std::vector<Record> filtered_records;
-    for (const auto& record : records) {
-        bool match = true;
-        if (!where_column.empty()) {
-            auto it = std::find(columns.begin(), columns.end(), where_column);
-            if (it != columns.end()) {
-                int idx = std::distance(columns.begin(), it);
-                if (record.fields[idx] != where_value) {
-                    match = false;
-                }
-            } else {
-                std::cerr << "Error: WHERE column " << where_column << " does not exist.\n";
-                return;
-            }
-        }
-        if (match) {
-            filtered_records.emplace_back(record);
-        }
-    }
-
-    // Handle ORDER BY
-    if (!order_by.empty()) {
-        // Check if order_by columns exist
-        std::vector<int> order_indices;
-        std::vector<std::string> order_directions;
-        for (const auto& ob : order_by) {
-            auto it = std::find(columns.begin(), columns.end(), ob.first);
-            if (it != columns.end()) {
-                order_indices.push_back(std::distance(columns.begin(), it));
-                order_directions.push_back(ob.second);
-            } else {
-                std::cerr << "Error: ORDER BY column " << ob.first << " does not exist.\n";
-                return;
-            }
-        }
-        // Sort the filtered_records
-        std::sort(filtered_records.begin(), filtered_records.end(),
-            [&](const Record& a, const Record& b) -> bool {
-                for (size_t i = 0; i < order_indices.size(); ++i) {
-                    int idx = order_indices[i];
-                    if (a.fields[idx] < b.fields[idx]) {
-                        return order_directions[i] == "ASC";
-                    }
-                    else if (a.fields[idx] > b.fields[idx]) {
-                        return order_directions[i] == "DESC";
-                    }
-                }
-                return false;
-            }
-        );
-    }
-
-    // Print header
-    if (select_columns.empty()) {
-        // For SELECT *
-        for (size_t i = 0; i < columns.size(); ++i) {
-            std::cout << std::left << std::setw(15) << columns[i];
-            if (i != columns.size() - 1 || !aggregates.empty()) std::cout << " | ";
-        }
-    } else {
-        for (size_t i = 0; i < select_columns.size(); ++i) {
-            std::cout << std::left << std::setw(15) << select_columns[i];
-            if (i != select_columns.size() - 1 || !aggregates.empty()) std::cout << " | ";
-        }
-    }
-    for (size_t i = 0; i < aggregates.size(); ++i) {
-        std::cout << std::left << std::setw(15) << (aggregates[i].first + "(" + aggregates[i].second + ")");
-        if (i != aggregates.size() - 1) std::cout << " | ";
-    }
-    std::cout << "\n";
-
-    // Print separator
-    size_t total_columns = select_columns.empty() ? columns.size() : select_columns.size();
-    for (size_t i = 0; i < total_columns; ++i) {
-        std::cout << "---------------";
-        if (i != total_columns - 1 || !aggregates.empty()) std::cout << "+";
-    }
-    for (size_t i = 0; i < aggregates.size(); ++i) {
-        std::cout << "---------------";
-        if (i != aggregates.size() - 1) std::cout << "+";
-    }
-    std::cout << "\n";
-
-    // Print records
-    for (const auto& record : filtered_records) {
-        for (size_t i = 0; i < col_indices.size(); ++i) {
-            std::cout << std::left << std::setw(15) << record.fields[col_indices[i]];
-            if (i != col_indices.size() - 1 || !aggregates.empty()) std::cout << " | ";
-        }
-        // Handle aggregates (if any without GROUP BY)
-        for (size_t i = 0; i < aggregates.size(); ++i) {
-            if (aggregates[i].first == "COUNT") {
-                if (aggregates[i].second == "*") {
-                    std::cout << std::left << std::setw(15) << "1"; // Each record counts as 1
-                }
-                else {
-                    // Count non-empty values in the specified column
-                    auto it = std::find(columns.begin(), columns.end(), aggregates[i].second);
-                    if (it != columns.end()) {
-                        int idx = std::distance(columns.begin(), it);
-                        int count = !record.fields[idx].empty() ? 1 : 0;
-                        std::cout << std::left << std::setw(15) << count;
-                    }
-                    else {
-                        std::cout << std::left << std::setw(15) << "0";
-                    }
-                }
-            }
-            // Future aggregate functions can be handled here
-            if (i != aggregates.size() - 1) std::cout << " | ";
-        }
-        std::cout << "\n";
-    }
-
-    // Handle global aggregates without GROUP BY
-    if (!aggregates.empty() && group_by.empty()) {
-        std::cout << "\n";
-        // Print aggregate results
-        for (size_t i = 0; i < aggregates.size(); ++i) {
-            if (aggregates[i].first == "COUNT") {
-                if (aggregates[i].second == "*") {
-                    std::cout << "COUNT(*) = " << filtered_records.size() << "\n";
-                }
-                else {
-                    // Count non-empty values in the specified column
-                    auto it = std::find(columns.begin(), columns.end(), aggregates[i].second);
-                    if (it != columns.end()) {
-                        int idx = std::distance(columns.begin(), it);
-                        int count = 0;
-                        for (const auto& rec : filtered_records) {
-                            if (!rec.fields[idx].empty()) {
-                                count++;
-                            }
-                        }
-                        std::cout << "COUNT(" << aggregates[i].second << ") = " << count << "\n";
-                    }
-                    else {
-                        std::cout << "COUNT(" << aggregates[i].second << ") = 0\n";
-                    }
-                }
-            }
-            // Future aggregate functions can be handled here
-        }
-    }
-}
-
-void Table::update(const std::string& set_column, const std::string& set_value, 
-                  const std::string& where_column, 
-                  const std::string& where_value) {
-    auto it = std::find(columns.begin(), columns.end(), set_column);
-    if (it == columns.end()) {
-        std::cerr << "Error: SET column " << set_column << " does not exist.\n";
-        return;
-    }
-    int set_idx = std::distance(columns.begin(), it);
-    int updated_count = 0;
-
-    for (auto& record : records) {
-        bool match = true;
-        if (!where_column.empty()) {
-            auto where_it = std::find(columns.begin(), columns.end(), where_column);
-            if (where_it != columns.end()) {
-                int where_idx = std::distance(columns.begin(), where_it);
-                if (record.fields[where_idx] != where_value) {
-                    match = false;
-                }
-            }
-            else {
-                std::cerr << "Error: WHERE column " << where_column << " does not exist.\n";
-                return;
-            }
-        }
-        if (match) {
-            record.fields[set_idx] = set_value;
-            updated_count++;
-        }
-    }
-    std::cout << "Updated " << updated_count << " record(s) in " << name << ".\n";
-}
-
-void Table::deleteRecords(const std::string& where_column, const std::string& where_value) {
-    if (!where_column.empty()) {
-        auto it = std::find(columns.begin(), columns.end(), where_column);
-        if (it == columns.end()) {
-            std::cerr << "Error: WHERE column " << where_column << " does not exist.\n";
-            return;
-        }
-    }
-    auto initial_size = records.size();
-    records.erase(
-        std::remove_if(records.begin(), records.end(),
-            [&](const Record& record) -> bool {
-                if (where_column.empty()) {
-                    return true; // Delete all
-                }
-                auto it = std::find(columns.begin(), columns.end(), where_column);
-                if (it != columns.end()) {
-                    int idx = std::distance(columns.begin(), it);
-                    return record.fields[idx] == where_value;
-                }
-                return false;
-            }),
-        records.end()
-    );
-    auto deleted_count = initial_size - records.size();
-    std::cout << "Deleted " << deleted_count << " record(s) from " << name << ".\n";
-}
-
-void Table::save() {
-    std::ofstream ofs(filepath, std::ios::trunc);
-    if (!ofs) {
-        std::cerr << "Error: Unable to open file " << filepath << " for writing.\n";
-        return;
-    }
-    // First line: column headers
-    for (size_t i = 0; i < columns.size(); ++i) {
-        ofs << columns[i];
-        if (i != columns.size() - 1) ofs << ",";
-    }
-    ofs << "\n";
-
-    // Records
-    for (const auto& record : records) {
-        for (size_t i = 0; i < record.fields.size(); ++i) {
-            // Escape commas in fields
-            std::string field = record.fields[i];
-            if (field.find(',') != std::string::npos) {
-                field = "\"" + field + "\"";
-            }
-            ofs << field;
-            if (i != record.fields.size() - 1) ofs << ",";
-        }
-        ofs << "\n";
-    }
-    ofs.close();
-}
-
-void Table::load() {
-    std::ifstream ifs(filepath);
-    if (!ifs) {
-        std::cerr << "Error: Unable to open file " << filepath << " for reading.\n";
-        return;
-    }
-    std::string line;
-    bool is_header = true;
-    while (std::getline(ifs, line)) {
-        std::stringstream ss(line);
-        std::string field;
-        std::vector<std::string> fields;
-        bool in_quotes = false;
-        std::string current_field;
-        for (size_t i = 0; i < line.size(); ++i) {
-            char c = line[i];
-            if (c == '"' ) {
-                in_quotes = !in_quotes;
-            }
-            else if (c == ',' && !in_quotes) {
-                fields.push_back(current_field);
-                current_field.clear();
-            }
-            else {
-                current_field += c;
-            }
-        }
-        fields.push_back(current_field);
-
-        if (is_header) {
-            columns = fields;
-            is_header = false;
-        } else {
-            records.emplace_back(fields);
-        }
-    }
-    ifs.close();
+// Table.cpp
+#include "Table.hpp"
+#include "Hash.hpp"
+#include "Metrics.hpp"
+#include "RowSorter.hpp"
+#include "ThreadPool.hpp"
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <iomanip>
+#include <cstring>
+#include <cmath>
+#include <filesystem>
+#include <atomic>
+
+// Initialize DATA_DIR as a constant
+const std::string DATA_DIR = "data/";
+// Second line of a .tbl file written in the encoded column layout
+const std::string COLUMNAR_MARKER = "#MINIDB-COLUMNAR";
+// Second line of a partitioned table's .tbl file, followed by the partition spec
+const std::string PARTITION_MARKER = "#MINIDB-PARTITIONED";
+// Per-group sketches stay small: 2^10 registers, about 3% standard error
+const unsigned GROUP_HLL_PRECISION = 10;
+// GROUP BY reserves memory for new groups at least this much at a time
+const size_t GROUP_MEMORY_CHUNK = 64 * 1024;
+
+// Threads one statement spreads its partitions over, its own included
+const size_t MAX_PARTITION_THREADS = 4;
+
+// Run fn(0) .. fn(count - 1) on the shared worker pool
+static void parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    ThreadPool::instance().parallelFor(count, MAX_PARTITION_THREADS, fn);
+}
+
+// Report the limit a stage's reservation of bytes ran into
+static void reportMemoryLimit(QueryContext& context, size_t bytes, const char* stage) {
+    *context.err << "Error: Out of memory in " << stage << ": " << bytes << " more bytes would exceed the "
+                 << context.memory.describeFailure(bytes) << ".\n";
+    Metrics::instance().add(Counter::MEMORY_LIMIT_ERRORS);
+}
+
+// Reserve operator memory for a stage, or report the limit it would exceed
+static bool reserveMemory(QueryContext& context, size_t bytes, const char* stage) {
+    if (context.memory.reserve(bytes)) return true;
+    reportMemoryLimit(context, bytes, stage);
+    return false;
+}
+
+// Files of a table's storage unit, for dropping a partition
+static void removeTableFiles(const std::string& table_name) {
+    for (const char* extension : {".tbl", ".zmap", ".bloom", ".stats", ".views"}) {
+        std::error_code ec;
+        std::filesystem::remove(DATA_DIR + table_name + extension, ec);
+    }
+}
+
+// Checksum of a data file's bytes; its zone map records it to detect a mismatched pair
+static uint64_t fileChecksum(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    uint64_t checksum = 0, total = 0;
+    std::vector<char> buffer(64 * 1024);
+    while (ifs.read(buffer.data(), buffer.size()) || ifs.gcount() > 0) {
+        size_t bytes = static_cast<size_t>(ifs.gcount());
+        total += bytes;
+        for (size_t i = 0; i < bytes; i += sizeof(uint64_t)) {
+            uint64_t word = 0;
+            std::memcpy(&word, buffer.data() + i, std::min(sizeof(uint64_t), bytes - i));
+            checksum = mixHash(checksum ^ word);
+        }
+    }
+    return mixHash(checksum ^ total);
+}
+
+uint64_t Table::nextVersion() {
+    static std::atomic<uint64_t> counter{1};
+    return counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+Table::Table(const std::string& name, const std::vector<std::string>& columns, const PartitionSpec& partitioning)
+    : name(name), columns(columns), partition_spec(partitioning) {
+    filepath = DATA_DIR + name + ".tbl";
+    zone_map.clear(columns.size());
+    for (size_t i = 0; i < partition_spec.count(); ++i) {
+        partitions.push_back(std::make_unique<Table>(partitionTableName(partition_spec.name(i)), columns));
+    }
+}
+
+Table::Table(const std::string& name) : name(name) {
+    filepath = DATA_DIR + name + ".tbl";
+    load();
+}
+
+void Table::insert(const std::vector<std::string>& fields, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& err = *context.err;
+    if (fields.size() != columns.size()) {
+        err << "Error: Field count doesn't match column count.\n";
+        return;
+    }
+    if (partition_spec.isPartitioned()) {
+        int partition = partition_spec.route(fields[partition_spec.getColumn()]);
+        if (partition < 0) {
+            err << "Error: No partition of " << name << " holds " << columns[partition_spec.getColumn()]
+                << " = " << fields[partition_spec.getColumn()] << ".\n";
+            return;
+        }
+        partitions[partition]->insert(fields, &context);
+        version = nextVersion();
+        return;
+    }
+    records.push_back(makeRecord(fields));
+    deleted.push_back(false);
+    zone_map.addRow(records.back());
+    addToBlooms(records.size() - 1);
+    stats.addRow(records.back());
+    for (auto& view : views) {
+        view.addRow(records.back());
+    }
+    version = nextVersion();
+    Metrics::instance().add(Counter::ROWS_INSERTED);
+}
+
+bool Table::setBloomColumns(const std::vector<std::string>& bloom_cols, double fpr) {
+    if (!(fpr > 0.0 && fpr < 1.0)) {
+        std::cerr << "Error: Bloom filter false-positive rate must be between 0 and 1.\n";
+        return false;
+    }
+    std::vector<int> indices;
+    for (const auto& col : bloom_cols) {
+        int idx = columnIndex(col);
+        if (idx < 0) {
+            std::cerr << "Error: BLOOM column " << col << " does not exist.\n";
+            return false;
+        }
+        if (std::find(indices.begin(), indices.end(), idx) == indices.end()) {
+            indices.push_back(idx);
+        }
+    }
+    bloom_columns = indices;
+    bloom_fpr = fpr;
+    rebuildBlooms();
+    for (auto& partition : partitions) {
+        if (partition->bloom_columns != indices || partition->bloom_fpr != fpr) {
+            partition->setBloomColumns(bloom_cols, fpr);
+        }
+    }
+    return true;
+}
+
+bool Table::hasBloom(const std::string& column) const {
+    int idx = columnIndex(column);
+    return idx >= 0 && std::find(bloom_columns.begin(), bloom_columns.end(), idx) != bloom_columns.end();
+}
+
+void Table::rebuildBlooms() {
+    blooms.clear();
+    blooms_stale = false;
+    if (bloom_columns.empty()) return;
+    for (size_t begin = 0; begin < records.size(); begin += ZONE_BLOCK_ROWS) {
+        size_t end = std::min(begin + ZONE_BLOCK_ROWS, records.size());
+        // Leave headroom for appends so small tables are not rebuilt on every insert
+        size_t capacity = std::min(ZONE_BLOCK_ROWS, std::max<size_t>(1024, 2 * (end - begin)));
+        std::vector<BloomFilter> filters(bloom_columns.size(), BloomFilter(capacity, bloom_fpr));
+        for (size_t row = begin; row < end; ++row) {
+            for (size_t i = 0; i < bloom_columns.size(); ++i) {
+                filters[i].add(records[row].fields[bloom_columns[i]]);
+            }
+        }
+        blooms.push_back(std::move(filters));
+    }
+}
+
+void Table::addToBlooms(size_t row) {
+    if (bloom_columns.empty()) return;
+    size_t block = row / ZONE_BLOCK_ROWS;
+    while (blooms.size() <= block) {
+        blooms.emplace_back(bloom_columns.size(), BloomFilter(1024, bloom_fpr));
+    }
+    for (size_t i = 0; i < bloom_columns.size(); ++i) {
+        BloomFilter& filter = blooms[block][i];
+        filter.add(records[row].fields[bloom_columns[i]]);
+        if (filter.saturated()) {
+            blooms_stale = true;
+        }
+    }
+}
+
+bool Table::bloomMayContain(size_t block, int column, const std::string& value) const {
+    if (block >= blooms.size()) return true;
+    for (size_t i = 0; i < bloom_columns.size(); ++i) {
+        if (bloom_columns[i] == column) {
+            return blooms[block][i].mayContain(value);
+        }
+    }
+    return true;
+}
+
+Table::Table(const Table& other) : name(other.name), columns(other.columns), pool(other.pool), filepath(other.filepath),
+    zone_map(other.zone_map), bloom_columns(other.bloom_columns), bloom_fpr(other.bloom_fpr), blooms(other.blooms),
+    blooms_stale(other.blooms_stale), encoded(other.encoded), encoded_rows(other.encoded_rows),
+    deleted(other.deleted), deleted_count(other.deleted_count), stats(other.stats), views(other.views),
+    version(other.version), saved_version(other.saved_version), partition_spec(other.partition_spec),
+    dropped_partitions(other.dropped_partitions) {
+    // Field arrays go into this copy's arena; the values themselves stay shared
+    records.reserve(other.records.size());
+    for (const auto& record : other.records) {
+        records.emplace_back(record, row_arena.get());
+    }
+    for (const auto& partition : other.partitions) {
+        partitions.push_back(std::make_unique<Table>(*partition));
+    }
+}
+
+Record Table::makeRecord(const std::vector<std::string>& fields) {
+    std::pmr::vector<std::string_view> views(row_arena.get());
+    views.reserve(fields.size());
+    for (const auto& field : fields) {
+        views.push_back(pool->intern(field));
+    }
+    return Record(std::move(views));
+}
+
+void Table::rebuildStorage() {
+    // Fresh pool and arena holding only what live rows still reference
+    auto fresh_pool = std::make_shared<StringPool>();
+    auto fresh_arena = std::make_unique<Arena>();
+    std::vector<Record> fresh;
+    fresh.reserve(records.size());
+    for (const auto& record : records) {
+        std::pmr::vector<std::string_view> views(fresh_arena.get());
+        views.reserve(record.fields.size());
+        for (const auto& field : record.fields) {
+            views.push_back(fresh_pool->intern(field));
+        }
+        fresh.emplace_back(std::move(views));
+        if (deleted[fresh.size() - 1]) {
+            for (const auto& field : fresh.back().fields) {
+                fresh_pool->release(field);
+            }
+        }
+    }
+    records = std::move(fresh); // old rows go before their arena
+    row_arena = std::move(fresh_arena);
+    pool = std::move(fresh_pool);
+}
+
+void Table::recountPool() {
+    for (auto& partition : partitions) {
+        partition->recountPool();
+    }
+    pool->clearReferences();
+    for (size_t row = 0; row < records.size(); ++row) {
+        if (deleted[row]) continue;
+        for (const auto& field : records[row].fields) {
+            pool->retain(field);
+        }
+    }
+}
+
+bool Table::compactPool() {
+    // While a transaction backup holds the pool, a rebuild would free nothing
+    if (!pool->worthRebuilding() || pool.use_count() > 1) {
+        return false;
+    }
+    rebuildStorage();
+    return true;
+}
+
+int Table::columnIndex(const std::string& column) const {
+    auto it = std::find(columns.begin(), columns.end(), column);
+    if (it == columns.end()) {
+        return -1;
+    }
+    return std::distance(columns.begin(), it);
+}
+
+size_t Table::scanSources(int where_idx, const std::string& where_value, QueryStats* stats, QueryMemory& memory,
+                          std::vector<ScanSource>& sources) const {
+    if (!partition_spec.isPartitioned()) {
+        sources.resize(1);
+        sources[0].table = this;
+        return matchingRows(where_idx, where_value, stats, memory, sources[0].rows);
+    }
+    // Each partition keeps its own block counts while the scans run
+    std::vector<size_t> targets = partition_spec.prune(where_idx, where_value);
+    std::vector<QueryStats> partition_stats(targets.size());
+    std::vector<size_t> failed(targets.size(), 0);
+    sources.resize(targets.size());
+    parallelFor(targets.size(), [&](size_t i) {
+        const Table& partition = *partitions[targets[i]];
+        sources[i].table = &partition;
+        failed[i] = partition.matchingRows(where_idx, where_value, &partition_stats[i], memory, sources[i].rows);
+    });
+    if (stats) {
+        for (const auto& partition : partition_stats) {
+            stats->blocks_scanned += partition.blocks_scanned;
+            stats->blocks_skipped += partition.blocks_skipped;
+            stats->bloom_skipped += partition.bloom_skipped;
+        }
+        stats->partitions_scanned += targets.size();
+        stats->partitions_pruned += partitions.size() - targets.size();
+    }
+    for (size_t bytes : failed) {
+        if (bytes != 0) return bytes;
+    }
+    return 0;
+}
+
+size_t Table::writePartitions(int where_idx, const std::string& where_value, QueryContext& context,
+                              const std::function<size_t(Table&, QueryContext&)>& write) {
+    std::vector<size_t> targets = partition_spec.prune(where_idx, where_value);
+    // Partitions report into their own streams; only errors are passed on
+    std::vector<std::ostringstream> outputs(targets.size()), errors(targets.size());
+    std::vector<QueryContext> contexts;
+    contexts.reserve(targets.size());
+    for (size_t i = 0; i < targets.size(); ++i) {
+        contexts.emplace_back(outputs[i], errors[i]);
+        contexts.back().memory.chargeTo(context.memory);
+    }
+    std::vector<size_t> counts(targets.size(), 0);
+    auto stage_start = StageClock::now();
+    parallelFor(targets.size(), [&](size_t i) {
+        counts[i] = write(*partitions[targets[i]], contexts[i]);
+    });
+    size_t total = 0;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        total += counts[i];
+        *context.err << errors[i].str();
+        context.stats.blocks_scanned += contexts[i].stats.blocks_scanned;
+        context.stats.blocks_skipped += contexts[i].stats.blocks_skipped;
+        context.stats.bloom_skipped += contexts[i].stats.bloom_skipped;
+    }
+    context.stats.partitions_scanned += targets.size();
+    context.stats.partitions_pruned += partitions.size() - targets.size();
+    context.stats.addStage("partitions", stage_start, targets.size(), total);
+    if (total > 0) version = nextVersion();
+    return total;
+}
+
+std::vector<const Table*> Table::getPartitions() const {
+    std::vector<const Table*> result;
+    for (const auto& partition : partitions) {
+        result.push_back(partition.get());
+    }
+    return result;
+}
+
+bool Table::addPartition(const std::string& partition, const std::string& upper_bound, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& err = *context.err;
+    std::string error;
+    if (!partition_spec.addRange(partition, upper_bound, error)) {
+        err << "Error: " << error << ".\n";
+        return false;
+    }
+    partitions.push_back(std::make_unique<Table>(partitionTableName(partition), columns));
+    if (!bloom_columns.empty()) {
+        std::vector<std::string> bloom_cols;
+        for (int idx : bloom_columns) {
+            bloom_cols.push_back(columns[idx]);
+        }
+        partitions.back()->setBloomColumns(bloom_cols, bloom_fpr);
+    }
+    version = nextVersion();
+    return true;
+}
+
+bool Table::dropPartition(const std::string& partition, QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& err = *context.err;
+    if (partition_spec.getMethod() != PartitionMethod::RANGE) {
+        err << "Error: DROP PARTITION requires RANGE partitioning.\n";
+        return false;
+    }
+    int index = partition_spec.find(partition);
+    if (index < 0) {
+        err << "Error: Partition " << partition << " of " << name << " does not exist.\n";
+        return false;
+    }
+    // No rows are touched: the partition's storage is detached as a whole
+    partition_spec.remove(index);
+    partitions.erase(partitions.begin() + index);
+    dropped_partitions.push_back(partition);
+    version = nextVersion();
+    return true;
+}
+
+size_t Table::memoryBytes() const {
+    size_t bytes = pool->bytesReserved() + row_arena->bytesReserved() + recordBytes();
+    for (const auto& partition : partitions) {
+        bytes += partition->memoryBytes();
+    }
+    return bytes;
+}
+
+size_t Table::backupBytes() const {
+    size_t bytes = row_arena->bytesReserved() + recordBytes() + deleted.capacity() / 8;
+    for (const auto& partition : partitions) {
+        bytes += partition->backupBytes();
+    }
+    return bytes;
+}
+
+size_t Table::rowCount() const {
+    size_t rows = records.size() - deleted_count;
+    for (const auto& partition : partitions) {
+        rows += partition->rowCount();
+    }
+    return rows;
+}
+
+size_t Table::deletedCount() const {
+    size_t rows = deleted_count;
+    for (const auto& partition : partitions) {
+        rows += partition->deletedCount();
+    }
+    return rows;
+}
+
+size_t Table::matchingRows(int where_idx, const std::string& where_value, QueryStats* stats, QueryMemory& memory,
+                           std::vector<size_t>& matches) const {
+    size_t blocks_scanned = 0, rows_scanned = 0, failed = 0;
+    for (size_t block = 0; block < zone_map.blockCount(); ++block) {
+        // Skip whole blocks whose min/max or null count rule out the predicate
+        if (where_idx >= 0 && !zone_map.mayContain(block, where_idx, where_value)) {
+            if (stats) stats->blocks_skipped++;
+            continue;
+        }
+        if (where_idx >= 0 && !bloomMayContain(block, where_idx, where_value)) {
+            if (stats) {
+                stats->blocks_skipped++;
+                stats->bloom_skipped++;
+            }
+            continue;
+        }
+        size_t begin = block * ZONE_BLOCK_ROWS;
+        size_t end = std::min(begin + ZONE_BLOCK_ROWS, records.size());
+        // Room for the whole block to match, so the positions never outgrow what is reserved
+        size_t needed = matches.size() + (end - begin);
+        if (needed > matches.capacity()) {
+            size_t capacity = std::min(std::max(needed, 2 * matches.capacity()), records.size());
+            size_t bytes = (capacity - matches.capacity()) * sizeof(size_t);
+            if (!memory.reserve(bytes)) {
+                failed = bytes;
+                break;
+            }
+            matches.reserve(capacity);
+        }
+        if (stats) stats->blocks_scanned++;
+        blocks_scanned++;
+        rows_scanned += end - begin;
+        size_t block_first = matches.size();
+        // Compare codes for the encoded part of the block, strings for the rest
+        if (where_idx >= 0 && isEncoded(where_idx) && begin < encoded_rows) {
+            size_t encoded_end = std::min(end, encoded_rows);
+            encoded[where_idx].findEqual(where_value, begin, encoded_end, matches);
+            begin = encoded_end;
+        }
+        for (size_t row = begin; row < end; ++row) {
+            if (where_idx < 0 || records[row].fields[where_idx] == where_value) {
+                matches.push_back(row);
+            }
+        }
+        // Tombstoned rows never match
+        if (deleted_count > 0) {
+            matches.erase(std::remove_if(matches.begin() + block_first, matches.end(),
+                                         [&](size_t row) { return deleted[row]; }),
+                          matches.end());
+        }
+    }
+    Metrics& metrics = Metrics::instance();
+    metrics.add(Counter::BLOCKS_SCANNED, blocks_scanned);
+    metrics.add(Counter::BLOCKS_SKIPPED, zone_map.blockCount() - blocks_scanned);
+    metrics.add(Counter::ROWS_SCANNED, rows_scanned);
+    return failed;
+}
+
+bool Table::isEncoded(int column) const {
+    return column >= 0 && static_cast<size_t>(column) < encoded.size() && encoded[column].isEncoded();
+}
+
+std::vector<EncodedColumn> Table::encodeRows(const std::vector<const Record*>& rows) const {
+    std::vector<EncodedColumn> result;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        result.push_back(EncodedColumn::encode(rows, i));
+    }
+    return result;
+}
+
+void Table::encodeColumns() {
+    // Only called without tombstones, so live rows are all rows
+    encoded = encodeRows(liveRows());
+    encoded_rows = records.size();
+}
+
+std::string Table::getEncoding(const std::string& column) const {
+    int idx = columnIndex(column);
+    return isEncoded(idx) ? encoded[idx].encodingName() : "PLAIN";
+}
+
+std::string Table::zoneMapPath() const {
+    return DATA_DIR + name + ".zmap";
+}
+
+std::string Table::bloomPath() const {
+    return DATA_DIR + name + ".bloom";
+}
+
+std::string Table::statsPath() const {
+    return DATA_DIR + name + ".stats";
+}
+
+void Table::analyze() {
+    for (auto& partition : partitions) {
+        partition->analyze();
+    }
+    if (partition_spec.isPartitioned()) {
+        version = nextVersion();
+        return; // statistics live with the partitions' rows
+    }
+    stats.analyze(liveRows(), columns.size());
+    version = nextVersion(); // APPROX_COUNT_DISTINCT may read the new sketches
+}
+
+bool Table::saveStats() const {
+    bool saved = true;
+    for (const auto& partition : partitions) {
+        saved = partition->saveStats() && saved;
+    }
+    return saved && (!stats.isAnalyzed() || stats.save(statsPath()));
+}
+
+std::string Table::viewsPath() const {
+    return DATA_DIR + name + ".views";
+}
+
+bool Table::createView(const std::string& view_name, const std::vector<std::string>& group_by,
+                       const std::vector<std::pair<std::string, std::string>>& aggregates,
+                       QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& err = *context.err;
+    if (partition_spec.isPartitioned()) {
+        err << "Error: Materialized views over partitioned table " << name << " are not supported.\n";
+        return false;
+    }
+    std::vector<int> group_columns;
+    for (const auto& column : group_by) {
+        int idx = columnIndex(column);
+        if (idx < 0) {
+            err << "Error: GROUP BY column " << column << " does not exist.\n";
+            return false;
+        }
+        group_columns.push_back(idx);
+    }
+    std::vector<ViewAggregate> view_aggregates;
+    for (const auto& agg : aggregates) {
+        ViewAggregate aggregate;
+        aggregate.function = agg.first;
+        if (agg.second == "*" && agg.first == "COUNT") {
+            aggregate.column = -1;
+        } else {
+            aggregate.column = columnIndex(agg.second);
+            if (aggregate.column < 0) {
+                err << "Error: " << agg.first << " target column " << agg.second << " does not exist.\n";
+                return false;
+            }
+        }
+        view_aggregates.push_back(aggregate);
+    }
+    views.emplace_back(view_name, group_columns, view_aggregates);
+    views.back().rebuild(liveRows());
+    return true;
+}
+
+bool Table::dropView(const std::string& view_name) {
+    auto it = std::find_if(views.begin(), views.end(),
+                           [&](const MaterializedView& view) { return view.getName() == view_name; });
+    if (it == views.end()) {
+        return false;
+    }
+    views.erase(it);
+    return true;
+}
+
+bool Table::refreshView(const std::string& view_name) {
+    for (auto& view : views) {
+        if (view.getName() == view_name) {
+            view.rebuild(liveRows());
+            version = nextVersion();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Table::rebuildDriftedViews() {
+    std::vector<const Record*> live;
+    bool rebuilt = false;
+    for (auto& view : views) {
+        if (view.hasDrifted()) {
+            if (!rebuilt) live = liveRows();
+            view.rebuild(live);
+            rebuilt = true;
+        }
+    }
+    return rebuilt;
+}
+
+const MaterializedView* Table::getView(const std::string& view_name) const {
+    for (const auto& view : views) {
+        if (view.getName() == view_name) return &view;
+    }
+    return nullptr;
+}
+
+bool Table::saveViews() const {
+    if (views.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(viewsPath(), ec);
+        return true;
+    }
+    std::ofstream ofs(viewsPath(), std::ios::trunc);
+    if (!ofs) {
+        return false;
+    }
+    for (const auto& view : views) {
+        ofs << view.serialize(columns) << "\n";
+    }
+    return true;
+}
+
+void Table::loadViews() {
+    std::ifstream ifs(viewsPath());
+    if (!ifs) {
+        return;
+    }
+    // Only definitions are stored; the group states are rebuilt from the rows
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (!line.empty() && !MaterializedView::deserialize(line, columns, views)) {
+            std::cerr << "Error: Corrupt view definition in " << viewsPath() << ".\n";
+        }
+    }
+    std::vector<const Record*> live = liveRows();
+    for (auto& view : views) {
+        view.rebuild(live);
+    }
+}
+
+void Table::select(const std::vector<std::string>& select_columns, 
+                  const std::vector<std::pair<std::string, std::string>>& aggregates,
+                  const std::string& where_column, 
+                  const std::string& where_value,
+                  const std::vector<std::pair<std::string, std::string>>& order_by,
+                  const std::vector<std::string>& group_by,
+                  QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    // Resolve WHERE column once
+    int where_idx = -1;
+    if (!where_column.empty()) {
+        where_idx = columnIndex(where_column);
+        if (where_idx < 0) {
+            err << "Error: WHERE column " << where_column << " does not exist.\n";
+            return;
+        }
+    }
+
+    // Determine columns to display
+    std::vector<int> col_indices;
+    // If selected_columns is empty (SELECT *), use all columns
+    if (select_columns.empty()) {
+        col_indices.resize(columns.size());
+        for (size_t i = 0; i < columns.size(); ++i) {
+            col_indices[i] = i;
+        }
+    } else {
+        for (const auto& col : select_columns) {
+            auto it = std::find(columns.begin(), columns.end(), col);
+            if (it != columns.end()) {
+                col_indices.push_back(std::distance(columns.begin(), it));
+            } else {
+                err << "Error: Column " << col << " does not exist.\n";
+                return;
+            }
+        }
+    }
+
+    // Handle GROUP BY
+    if (!group_by.empty()) {
+        // Ensure all group_by columns exist
+        std::vector<int> group_indices;
+        for (const auto& gb_col : group_by) {
+            auto it = std::find(columns.begin(), columns.end(), gb_col);
+            if (it != columns.end()) {
+                group_indices.push_back(std::distance(columns.begin(), it));
+            } else {
+                err << "Error: GROUP BY column " << gb_col << " does not exist.\n";
+                return;
+            }
+        }
+
+        // Prepare aggregate functions
+        std::vector<std::pair<std::string, int>> agg_functions; // function name and column index (-1 for COUNT(*))
+        for (const auto& agg : aggregates) {
+            std::string func = agg.first;
+            std::string target = agg.second;
+            std::transform(func.begin(), func.end(), func.begin(), ::toupper);
+            if (func == "COUNT") {
+                if (target == "*" ) {
+                    agg_functions.emplace_back(func, -1);
+                } else {
+                    auto it = std::find(columns.begin(), columns.end(), target);
+                    if (it != columns.end()) {
+                        agg_functions.emplace_back(func, std::distance(columns.begin(), it));
+                    } else {
+                        err << "Error: COUNT target column " << target << " does not exist.\n";
+                        return;
+                    }
+                }
+            }
+            else if (func == "APPROX_COUNT_DISTINCT") {
+                auto it = std::find(columns.begin(), columns.end(), target);
+                if (it == columns.end()) {
+                    err << "Error: APPROX_COUNT_DISTINCT target column " << target << " does not exist.\n";
+                    return;
+                }
+                agg_functions.emplace_back(func, std::distance(columns.begin(), it));
+            }
+            else {
+                err << "Error: Unsupported aggregate function '" << func << "'.\n";
+                return;
+            }
+        }
+
+        // Only APPROX_COUNT_DISTINCT aggregates get a sketch per group
+        std::vector<size_t> sketch_of(agg_functions.size(), 0);
+        size_t sketch_count = 0;
+        for (size_t i = 0; i < agg_functions.size(); ++i) {
+            if (agg_functions[i].first == "APPROX_COUNT_DISTINCT") sketch_of[i] = sketch_count++;
+        }
+
+        // Group records, keeping per-group counts instead of row copies
+        struct GroupState {
+            size_t rows = 0;
+            std::vector<size_t> non_empty; // per aggregate, for COUNT(column)
+            std::vector<HyperLogLog> distinct; // per sketch, for APPROX_COUNT_DISTINCT
+        };
+        auto accumulate = [&](GroupState& group, const Record& record) {
+            if (group.non_empty.empty()) {
+                group.non_empty.resize(agg_functions.size(), 0);
+                group.distinct.resize(sketch_count, HyperLogLog(GROUP_HLL_PRECISION));
+            }
+            group.rows++;
+            for (size_t i = 0; i < agg_functions.size(); ++i) {
+                if (agg_functions[i].second != -1 && !record.fields[agg_functions[i].second].empty()) {
+                    group.non_empty[i]++;
+                    if (agg_functions[i].first == "APPROX_COUNT_DISTINCT") {
+                        group.distinct[sketch_of[i]].add(record.fields[agg_functions[i].second]);
+                    }
+                }
+            }
+        };
+        std::map<std::string, GroupState> grouped_records;
+        auto stage_start = StageClock::now();
+        std::vector<ScanSource> sources;
+        size_t failed = scanSources(where_idx, where_value, &context.stats, context.memory, sources);
+        size_t matched = 0, match_bytes = 0;
+        for (const auto& source : sources) {
+            matched += source.rows.size();
+            match_bytes += source.rows.capacity() * sizeof(size_t);
+        }
+        context.stats.addStage("scan", stage_start, rowCount(), matched, match_bytes);
+        if (failed != 0) {
+            reportMemoryLimit(context, failed, "scan");
+            return;
+        }
+        stage_start = StageClock::now();
+        // Groups are charged in chunks as they appear: map node, counters and sketches
+        const size_t group_estimate = sizeof(GroupState) + 64 + agg_functions.size() * sizeof(size_t) +
+            sketch_count * (sizeof(HyperLogLog) + (size_t(1) << GROUP_HLL_PRECISION));
+        size_t group_reserved = 0, rows_grouped = 0;
+        auto charge_groups = [&](size_t groups) {
+            size_t needed = groups * group_estimate;
+            if (needed <= group_reserved) return true;
+            size_t more = std::max(needed - group_reserved, GROUP_MEMORY_CHUNK);
+            if (!reserveMemory(context, more, "group")) return false;
+            group_reserved += more;
+            return true;
+        };
+        bool group_encoded = !sources.empty();
+        for (const auto& source : sources) {
+            // Rows covered by encoded group columns are grouped on their codes,
+            // which only mean something within one storage unit
+            const Table& unit = *source.table;
+            bool unit_encoded = std::all_of(group_indices.begin(), group_indices.end(),
+                                            [&](int idx) { return unit.isEncoded(idx); });
+            group_encoded = group_encoded && unit_encoded;
+            std::unordered_map<std::string, GroupState> coded_groups;
+            for (size_t row : source.rows) {
+                if (++rows_grouped % 4096 == 0 && !charge_groups(grouped_records.size() + coded_groups.size())) {
+                    return;
+                }
+                const Record& record = unit.records[row];
+                if (unit_encoded && row < unit.encoded_rows) {
+                    std::string code_key;
+                    for (const auto& idx : group_indices) {
+                        uint32_t code = unit.encoded[idx].codeAt(row);
+                        code_key.append(reinterpret_cast<const char*>(&code), sizeof(code));
+                    }
+                    accumulate(coded_groups[code_key], record);
+                    continue;
+                }
+                std::string key;
+                for (const auto& idx : group_indices) {
+                    key.append(record.fields[idx]);
+                    key += '_';
+                }
+                accumulate(grouped_records[key], record);
+            }
+            // Decode each distinct code tuple once
+            for (const auto& pair : coded_groups) {
+                std::string key;
+                for (size_t i = 0; i < group_indices.size(); ++i) {
+                    uint32_t code;
+                    std::memcpy(&code, pair.first.data() + i * sizeof(code), sizeof(code));
+                    key += unit.encoded[group_indices[i]].decode(code) + "_";
+                }
+                GroupState& group = grouped_records[key];
+                group.non_empty.resize(agg_functions.size(), 0);
+                group.distinct.resize(sketch_count, HyperLogLog(GROUP_HLL_PRECISION));
+                group.rows += pair.second.rows;
+                for (size_t i = 0; i < agg_functions.size(); ++i) {
+                    group.non_empty[i] += pair.second.non_empty[i];
+                }
+                for (size_t s = 0; s < sketch_count; ++s) {
+                    group.distinct[s].merge(pair.second.distinct[s]);
+                }
+            }
+            if (!charge_groups(grouped_records.size())) return;
+        }
+        size_t group_bytes = 0;
+        for (const auto& pair : grouped_records) {
+            group_bytes += sizeof(pair) + pair.first.capacity() + pair.second.non_empty.capacity() * sizeof(size_t)
+                           + pair.second.distinct.size() * (size_t(1) << GROUP_HLL_PRECISION);
+        }
+        context.stats.addStage(group_encoded ? "group (codes)" : "group", stage_start,
+                               matched, grouped_records.size(), group_bytes);
+        stage_start = StageClock::now();
+
+        // Print header
+        for (size_t i = 0; i < group_by.size(); ++i) {
+            out << std::left << std::setw(15) << group_by[i];
+            if (i != group_by.size() - 1 || !agg_functions.empty()) out << " | ";
+        }
+        for (size_t i = 0; i < agg_functions.size(); ++i) {
+            out << std::left << std::setw(15) << (agg_functions[i].second == -1 ? "COUNT(*)" : agg_functions[i].first + "(" + columns[agg_functions[i].second] + ")");
+            if (i != agg_functions.size() - 1) out << " | ";
+        }
+        out << "\n";
+
+        // Print separator
+        for (size_t i = 0; i < group_by.size(); ++i) {
+            out << "---------------";
+            if (i != group_by.size() - 1 || !agg_functions.empty()) out << "+";
+        }
+        for (size_t i = 0; i < agg_functions.size(); ++i) {
+            out << "---------------";
+            if (i != agg_functions.size() - 1) out << "+";
+        }
+        out << "\n";
+
+        // Print grouped records with aggregates
+        for (const auto& pair : grouped_records) {
+            std::stringstream ss(pair.first);
+            std::string value;
+            size_t idx = 0;
+            while (std::getline(ss, value, '_')) {
+                if (idx < group_by.size()) {
+                    out << std::left << std::setw(15) << value;
+                    if (idx != group_by.size() - 1 || !agg_functions.empty()) out << " | ";
+                }
+                idx++;
+            }
+            for (size_t i = 0; i < agg_functions.size(); ++i) {
+                if (agg_functions[i].first == "COUNT") {
+                    if (agg_functions[i].second == -1) {
+                        out << std::left << std::setw(15) << pair.second.rows;
+                    }
+                    else {
+                        // Count non-empty values in the specified column
+                        out << std::left << std::setw(15) << pair.second.non_empty[i];
+                    }
+                }
+                else if (agg_functions[i].first == "APPROX_COUNT_DISTINCT") {
+                    out << std::left << std::setw(15) << pair.second.distinct[sketch_of[i]].estimate();
+                }
+                if (i != agg_functions.size() - 1) out << " | ";
+            }
+            out << "\n";
+        }
+        context.stats.addStage("output", stage_start, grouped_records.size(), grouped_records.size());
+        Metrics::instance().add(Counter::ROWS_RETURNED, grouped_records.size());
+        return;
+    }
+
+    // Filter records based on WHERE clause
+    auto stage_start = StageClock::now();
+    std::vector<ScanSource> sources;
+    size_t failed = scanSources(where_idx, where_value, &context.stats, context.memory, sources);
+    size_t matched = 0, match_bytes = 0;
+    for (const auto& source : sources) {
+        matched += source.rows.size();
+        match_bytes += source.rows.capacity() * sizeof(size_t);
+    }
+    context.stats.addStage("scan", stage_start, rowCount(), matched, match_bytes);
+    if (failed != 0) {
+        reportMemoryLimit(context, failed, "scan");
+        return;
+    }
+    if (!reserveMemory(context, matched * sizeof(const Record*), "materialize")) {
+        return;
+    }
+    stage_start = StageClock::now();
+    // Rows stay where they are; later stages only move pointers
+    std::vector<const Record*> filtered_records;
+    filtered_records.reserve(matched);
+    for (const auto& source : sources) {
+        for (size_t row : source.rows) {
+            filtered_records.push_back(&source.table->records[row]);
+        }
+    }
+    context.stats.addStage("materialize", stage_start, matched, filtered_records.size(),
+                           filtered_records.capacity() * sizeof(const Record*));
+
+    // Handle ORDER BY
+    if (!order_by.empty()) {
+        // Check if order_by columns exist
+        std::vector<SortKey> sort_keys;
+        for (const auto& ob : order_by) {
+            auto it = std::find(columns.begin(), columns.end(), ob.first);
+            if (it != columns.end()) {
+                sort_keys.push_back({static_cast<int>(std::distance(columns.begin(), it)), ob.second == "DESC"});
+            } else {
+                err << "Error: ORDER BY column " << ob.first << " does not exist.\n";
+                return;
+            }
+        }
+        // Sort a permutation, then reorder the row pointers once
+        size_t sort_bytes = RowSorter::workingBytes(filtered_records.size());
+        if (!reserveMemory(context, sort_bytes, "sort")) return;
+        stage_start = StageClock::now();
+        bool radix = false;
+        std::vector<size_t> permutation = RowSorter::order(filtered_records, sort_keys, &radix);
+        std::vector<const Record*> sorted_records;
+        sorted_records.reserve(permutation.size());
+        for (size_t position : permutation) {
+            sorted_records.push_back(filtered_records[position]);
+        }
+        filtered_records.swap(sorted_records);
+        context.memory.release(sort_bytes);
+        context.stats.addStage(radix ? "sort (radix)" : "sort", stage_start, filtered_records.size(),
+                               filtered_records.size(), permutation.capacity() * (sizeof(size_t) + sizeof(uint64_t)));
+    }
+
+    // Print header
+    stage_start = StageClock::now();
+    if (select_columns.empty()) {
+        // For SELECT *
+        for (size_t i = 0; i < columns.size(); ++i) {
+            out << std::left << std::setw(15) << columns[i];
+            if (i != columns.size() - 1 || !aggregates.empty()) out << " | ";
+        }
+    } else {
+        for (size_t i = 0; i < select_columns.size(); ++i) {
+            out << std::left << std::setw(15) << select_columns[i];
+            if (i != select_columns.size() - 1 || !aggregates.empty()) out << " | ";
+        }
+    }
+    for (size_t i = 0; i < aggregates.size(); ++i) {
+        out << std::left << std::setw(15) << (aggregates[i].first + "(" + aggregates[i].second + ")");
+        if (i != aggregates.size() - 1) out << " | ";
+    }
+    out << "\n";
+
+    // Print separator
+    size_t total_columns = select_columns.empty() ? columns.size() : select_columns.size();
+    for (size_t i = 0; i < total_columns; ++i) {
+        out << "---------------";
+        if (i != total_columns - 1 || !aggregates.empty()) out << "+";
+    }
+    for (size_t i = 0; i < aggregates.size(); ++i) {
+        out << "---------------";
+        if (i != aggregates.size() - 1) out << "+";
+    }
+    out << "\n";
+
+    // Print records
+    for (const auto& record : filtered_records) {
+        for (size_t i = 0; i < col_indices.size(); ++i) {
+            out << std::left << std::setw(15) << record->fields[col_indices[i]];
+            if (i != col_indices.size() - 1 || !aggregates.empty()) out << " | ";
+        }
+        // Handle aggregates (if any without GROUP BY)
+        for (size_t i = 0; i < aggregates.size(); ++i) {
+            if (aggregates[i].first == "COUNT" || aggregates[i].first == "APPROX_COUNT_DISTINCT") {
+                if (aggregates[i].second == "*") {
+                    out << std::left << std::setw(15) << "1"; // Each record counts as 1
+                }
+                else {
+                    // Count non-empty values in the specified column
+                    auto it = std::find(columns.begin(), columns.end(), aggregates[i].second);
+                    if (it != columns.end()) {
+                        int idx = std::distance(columns.begin(), it);
+                        int count = !record->fields[idx].empty() ? 1 : 0;
+                        out << std::left << std::setw(15) << count;
+                    }
+                    else {
+                        out << std::left << std::setw(15) << "0";
+                    }
+                }
+            }
+            // Future aggregate functions can be handled here
+            if (i != aggregates.size() - 1) out << " | ";
+        }
+        out << "\n";
+    }
+
+    // Handle global aggregates without GROUP BY
+    if (!aggregates.empty() && group_by.empty()) {
+        out << "\n";
+        // Print aggregate results
+        for (size_t i = 0; i < aggregates.size(); ++i) {
+            if (aggregates[i].first == "COUNT") {
+                if (aggregates[i].second == "*") {
+                    out << "COUNT(*) = " << filtered_records.size() << "\n";
+                }
+                else {
+                    // Count non-empty values in the specified column
+                    auto it = std::find(columns.begin(), columns.end(), aggregates[i].second);
+                    if (it != columns.end()) {
+                        int idx = std::distance(columns.begin(), it);
+                        int count = 0;
+                        for (const auto& rec : filtered_records) {
+                            if (!rec->fields[idx].empty()) {
+                                count++;
+                            }
+                        }
+                        out << "COUNT(" << aggregates[i].second << ") = " << count << "\n";
+                    }
+                    else {
+                        out << "COUNT(" << aggregates[i].second << ") = 0\n";
+                    }
+                }
+            }
+            else if (aggregates[i].first == "APPROX_COUNT_DISTINCT") {
+                auto it = std::find(columns.begin(), columns.end(), aggregates[i].second);
+                uint64_t estimate = 0;
+                if (it != columns.end()) {
+                    size_t idx = std::distance(columns.begin(), it);
+                    if (where_idx == -1 && stats.isAnalyzed() && stats.sketchesExact()) {
+                        // The whole table's sketch is still exact since ANALYZE
+                        estimate = stats.distinctEstimate(idx);
+                    } else {
+                        HyperLogLog sketch;
+                        for (const auto& rec : filtered_records) {
+                            if (!rec->fields[idx].empty()) sketch.add(rec->fields[idx]);
+                        }
+                        estimate = sketch.estimate();
+                    }
+                }
+                out << "APPROX_COUNT_DISTINCT(" << aggregates[i].second << ") = " << estimate << "\n";
+            }
+            // Future aggregate functions can be handled here
+        }
+    }
+    context.stats.addStage("output", stage_start, filtered_records.size(), filtered_records.size());
+    Metrics::instance().add(Counter::ROWS_RETURNED, filtered_records.size());
+}
+
+bool Table::explainScan(const std::string& where_column, const std::string& where_value, QueryContext* ctx) const {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    if (partition_spec.isPartitioned()) {
+        int where_idx = -1;
+        if (!where_column.empty() && (where_idx = columnIndex(where_column)) < 0) {
+            err << "Error: WHERE column " << where_column << " does not exist.\n";
+            return false;
+        }
+        std::vector<size_t> targets = partition_spec.prune(where_idx, where_value);
+        out << "Partitions of " << name << ": " << partition_spec.methodName() << "("
+            << columns[partition_spec.getColumn()] << "), scan " << targets.size() << " of " << partitions.size()
+            << (targets.size() > 1 ? " in parallel" : "") << "\n";
+        for (size_t target : targets) {
+            partitions[target]->explainScan(where_column, where_value, &context);
+        }
+        return true;
+    }
+    if (where_column.empty()) {
+        out << "Scan " << name << ": full scan of " << rowCount() << " row(s) in "
+            << zone_map.blockCount() << " block(s)\n";
+        return true;
+    }
+    int where_idx = columnIndex(where_column);
+    if (where_idx < 0) {
+        err << "Error: WHERE column " << where_column << " does not exist.\n";
+        return false;
+    }
+    // Block pruning only reads metadata, so it is exact without touching rows
+    size_t zone_pruned = 0, bloom_pruned = 0;
+    for (size_t block = 0; block < zone_map.blockCount(); ++block) {
+        if (!zone_map.mayContain(block, where_idx, where_value)) {
+            zone_pruned++;
+        } else if (!bloomMayContain(block, where_idx, where_value)) {
+            bloom_pruned++;
+        }
+    }
+    size_t blocks = zone_map.blockCount();
+    out << "Scan " << name << ": filter " << where_column << " = '" << where_value << "', "
+        << blocks - zone_pruned - bloom_pruned << " of " << blocks << " block(s) to scan\n";
+    out << "  Zone map: " << zone_pruned << " block(s) pruned\n";
+    if (std::find(bloom_columns.begin(), bloom_columns.end(), where_idx) != bloom_columns.end()) {
+        out << "  Bloom filter: " << bloom_pruned << " block(s) pruned\n";
+    }
+    if (isEncoded(where_idx) && encoded_rows > 0) {
+        out << "  Match: " << encoded[where_idx].encodingName() << " codes for " << encoded_rows
+            << " row(s), string compare for " << records.size() - encoded_rows << "\n";
+    } else {
+        out << "  Match: string compare\n";
+    }
+    if (stats.isAnalyzed()) {
+        out << "  Estimated rows: " << std::llround(stats.estimateEqual(where_idx, where_value)) << "\n";
+    }
+    if (deleted_count > 0) {
+        out << "  Tombstones: " << deleted_count << " deleted row(s) skipped\n";
+    }
+    return true;
+}
+
+bool Table::explain(const std::vector<std::string>& select_columns,
+                    const std::vector<std::pair<std::string, std::string>>& aggregates,
+                    const std::string& where_column,
+                    const std::string& where_value,
+                    const std::vector<std::pair<std::string, std::string>>& order_by,
+                    const std::vector<std::string>& group_by,
+                    QueryContext* ctx) const {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    for (const auto& col : select_columns) {
+        if (columnIndex(col) < 0) {
+            err << "Error: Column " << col << " does not exist.\n";
+            return false;
+        }
+    }
+    if (!explainScan(where_column, where_value, &context)) {
+        return false;
+    }
+    if (!group_by.empty()) {
+        // Codes are per storage unit, so every partition must be encoded
+        std::vector<const Table*> units = partition_spec.isPartitioned() ? getPartitions()
+                                                                         : std::vector<const Table*>{this};
+        bool group_encoded = !units.empty();
+        size_t units_encoded_rows = 0;
+        for (const Table* unit : units) {
+            units_encoded_rows += unit->encoded_rows;
+        }
+        for (const auto& col : group_by) {
+            int idx = columnIndex(col);
+            if (idx < 0) {
+                err << "Error: GROUP BY column " << col << " does not exist.\n";
+                return false;
+            }
+            for (const Table* unit : units) {
+                group_encoded = group_encoded && unit->isEncoded(idx);
+            }
+        }
+        if (group_encoded) {
+            out << "Group: hash on encoded codes for " << units_encoded_rows
+                << " row(s), decoded into an ordered map\n";
+        } else {
+            out << "Group: ordered map on concatenated values\n";
+        }
+        out << "Aggregate: " << aggregates.size() << " function(s) per group\n";
+        out << "Output: one row per group\n";
+        return true;
+    }
+    out << "Materialize: collect pointers to matching rows\n";
+    if (!order_by.empty()) {
+        out << "Sort: permutation by 8-byte normalized key (radix from " << RADIX_SORT_MIN_ROWS
+            << " rows), comparator on ties:";
+        for (const auto& ob : order_by) {
+            if (columnIndex(ob.first) < 0) {
+                err << "Error: ORDER BY column " << ob.first << " does not exist.\n";
+                return false;
+            }
+            out << " " << ob.first << " " << ob.second;
+        }
+        out << "\n";
+    }
+    if (!aggregates.empty()) {
+        out << "Aggregate: " << aggregates.size() << " function(s) over all rows\n";
+    }
+    out << "Output: " << (select_columns.empty() ? columns.size() : select_columns.size()) << " column(s)\n";
+    return true;
+}
+
+size_t Table::diskBytes() const {
+    size_t bytes = 0;
+    for (const std::string& path : {filepath, zoneMapPath(), bloomPath(), statsPath(), viewsPath()}) {
+        std::error_code ec;
+        uintmax_t size = std::filesystem::file_size(path, ec);
+        if (!ec) bytes += size;
+    }
+    for (const auto& partition : partitions) {
+        bytes += partition->diskBytes();
+    }
+    return bytes;
+}
+
+size_t Table::update(const std::string& set_column, const std::string& set_value, 
+                  const std::string& where_column, 
+                  const std::string& where_value,
+                  QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    int set_idx = columnIndex(set_column);
+    if (set_idx < 0) {
+        err << "Error: SET column " << set_column << " does not exist.\n";
+        return 0;
+    }
+    int where_idx = -1;
+    if (!where_column.empty()) {
+        where_idx = columnIndex(where_column);
+        if (where_idx < 0) {
+            err << "Error: WHERE column " << where_column << " does not exist.\n";
+            return 0;
+        }
+    }
+    if (partition_spec.isPartitioned()) {
+        if (set_idx == partition_spec.getColumn()) {
+            // The row would have to move to another partition
+            err << "Error: Cannot UPDATE partition column " << set_column << "; DELETE and INSERT the row instead.\n";
+            return 0;
+        }
+        size_t updated = writePartitions(where_idx, where_value, context, [&](Table& partition, QueryContext& partition_context) {
+            return partition.update(set_column, set_value, where_column, where_value, &partition_context);
+        });
+        out << "Updated " << updated << " record(s) in " << name << ".\n";
+        return updated;
+    }
+    size_t updated_count = 0;
+
+    auto stage_start = StageClock::now();
+    std::vector<size_t> matches;
+    size_t failed = matchingRows(where_idx, where_value, &context.stats, context.memory, matches);
+    context.stats.addStage("scan", stage_start, rowCount(), matches.size(), matches.capacity() * sizeof(size_t));
+    if (failed != 0) {
+        reportMemoryLimit(context, failed, "scan");
+        return 0;
+    }
+    stage_start = StageClock::now();
+    for (size_t row : matches) {
+        Record& record = records[row];
+        zone_map.updateValue(row, set_idx, record.fields[set_idx], set_value);
+        stats.updateValue(set_idx, record.fields[set_idx], set_value);
+        for (auto& view : views) {
+            view.removeRow(record);
+        }
+        if (record.fields[set_idx] != set_value) {
+            pool->release(record.fields[set_idx]);
+            record.fields[set_idx] = pool->intern(set_value);
+        }
+        for (auto& view : views) {
+            view.addRow(record);
+        }
+        if (isEncoded(set_idx)) {
+            encoded[set_idx] = EncodedColumn(); // raw until the next checkpoint
+        }
+        if (std::find(bloom_columns.begin(), bloom_columns.end(), set_idx) != bloom_columns.end()) {
+            addToBlooms(row);
+            blooms_stale = true; // old value stays set until rebuilt
+        }
+        updated_count++;
+    }
+    if (updated_count > 0) version = nextVersion();
+    context.stats.addStage("update", stage_start, matches.size(), updated_count);
+    Metrics::instance().add(Counter::ROWS_UPDATED, updated_count);
+    out << "Updated " << updated_count << " record(s) in " << name << ".\n";
+    return updated_count;
+}
+
+size_t Table::deleteRecords(const std::string& where_column, const std::string& where_value,
+                          QueryContext* ctx) {
+    QueryContext default_context;
+    QueryContext& context = ctx ? *ctx : default_context;
+    std::ostream& out = *context.out;
+    std::ostream& err = *context.err;
+    int where_idx = -1;
+    if (!where_column.empty()) {
+        where_idx = columnIndex(where_column);
+        if (where_idx < 0) {
+            err << "Error: WHERE column " << where_column << " does not exist.\n";
+            return 0;
+        }
+    }
+    if (partition_spec.isPartitioned()) {
+        size_t removed = writePartitions(where_idx, where_value, context, [&](Table& partition, QueryContext& partition_context) {
+            return partition.deleteRecords(where_column, where_value, &partition_context);
+        });
+        out << "Deleted " << removed << " record(s) from " << name << ".\n";
+        return removed;
+    }
+    // Tombstone matching rows; nothing moves, so row positions stay valid
+    auto stage_start = StageClock::now();
+    std::vector<size_t> matches;
+    size_t failed = matchingRows(where_idx, where_value, &context.stats, context.memory, matches);
+    context.stats.addStage("scan", stage_start, rowCount(), matches.size(), matches.capacity() * sizeof(size_t));
+    if (failed != 0) {
+        reportMemoryLimit(context, failed, "scan");
+        return 0;
+    }
+    stage_start = StageClock::now();
+    for (size_t row : matches) {
+        deleted[row] = true;
+        for (const auto& field : records[row].fields) {
+            pool->release(field);
+        }
+        stats.removeRow(records[row]);
+        for (auto& view : views) {
+            view.removeRow(records[row]);
+        }
+    }
+    deleted_count += matches.size();
+    if (!matches.empty()) version = nextVersion();
+    context.stats.addStage("delete", stage_start, matches.size(), matches.size());
+    Metrics::instance().add(Counter::ROWS_DELETED, matches.size());
+    out << "Deleted " << matches.size() << " record(s) from " << name << ".\n";
+
+    // Compact automatically once tombstones outnumber live rows
+    if (deleted_count * 2 > records.size()) {
+        stage_start = StageClock::now();
+        size_t before = records.size();
+        vacuum();
+        context.stats.addStage("vacuum", stage_start, before, records.size());
+    }
+    return matches.size();
+}
+
+size_t Table::vacuum() {
+    if (partition_spec.isPartitioned()) {
+        std::vector<size_t> reclaimed(partitions.size(), 0);
+        parallelFor(partitions.size(), [&](size_t i) { reclaimed[i] = partitions[i]->vacuum(); });
+        size_t total = 0;
+        for (size_t count : reclaimed) {
+            total += count;
+        }
+        if (total > 0) version = nextVersion();
+        return total;
+    }
+    size_t reclaimed = deleted_count;
+    if (reclaimed == 0) {
+        // No rows to drop, but updates may have left values nothing references
+        compactPool();
+        if (rebuildDriftedViews()) version = nextVersion();
+        return 0;
+    }
+    size_t kept = 0;
+    for (size_t row = 0; row < records.size(); ++row) {
+        if (!deleted[row]) {
+            if (kept != row) records[kept] = std::move(records[row]);
+            kept++;
+        }
+    }
+    records.resize(kept);
+    deleted.assign(kept, false);
+    deleted_count = 0;
+
+    // Row positions changed: rebuild storage and every per-position structure
+    rebuildStorage();
+    zone_map.rebuild(records, columns.size());
+    rebuildBlooms();
+    encodeColumns();
+    rebuildDriftedViews();
+    version = nextVersion();
+    Metrics::instance().add(Counter::ROWS_VACUUMED, reclaimed);
+    return reclaimed;
+}
+
+std::vector<const Record*> Table::liveRows() const {
+    std::vector<const Record*> rows;
+    rows.reserve(records.size() - deleted_count);
+    for (size_t row = 0; row < records.size(); ++row) {
+        if (!deleted[row]) rows.push_back(&records[row]);
+    }
+    return rows;
+}
+
+void Table::save() {
+    ScopedLatency latency(Latency::SAVE);
+    Metrics::instance().add(Counter::SAVES);
+    std::ofstream ofs(filepath, std::ios::trunc);
+    if (!ofs) {
+        std::cerr << "Error: Unable to open file " << filepath << " for writing.\n";
+        return;
+    }
+    // First line: column headers
+    for (size_t i = 0; i < columns.size(); ++i) {
+        ofs << columns[i];
+        if (i != columns.size() - 1) ofs << ",";
+    }
+    ofs << "\n";
+
+    if (partition_spec.isPartitioned()) {
+        // The spec replaces the rows; partitions written since the last save are saved on their own.
+        // Dropped partitions' files go first, so a name dropped and re-added gets only fresh files.
+        ofs << PARTITION_MARKER << " ";
+        partition_spec.write(ofs);
+        ofs.close();
+        for (const auto& partition : dropped_partitions) {
+            removeTableFiles(partitionTableName(partition));
+        }
+        dropped_partitions.clear();
+        for (auto& partition : partitions) {
+            if (partition->version != partition->saved_version) {
+                partition->save();
+            }
+        }
+        if (!saveBloomSettings()) {
+            std::cerr << "Error: Unable to write Bloom filter settings for " << name << ".\n";
+        }
+        saved_version = version;
+        return;
+    }
+
+    compactPool();
+    // Checkpoint: pick an encoding per column over the live rows; fall back to CSV rows if none pays off.
+    // Tombstoned rows are left out of the file, so it is always compact.
+    std::vector<const Record*> live = liveRows();
+    std::vector<EncodedColumn> disk_encoded = encodeRows(live);
+    bool columnar = false;
+    for (const auto& column : disk_encoded) {
+        columnar = columnar || column.isEncoded();
+    }
+    if (columnar) {
+        ofs << COLUMNAR_MARKER << " " << live.size() << "\n";
+        for (size_t i = 0; i < columns.size(); ++i) {
+            disk_encoded[i].write(ofs);
+            if (!disk_encoded[i].isEncoded()) {
+                for (const Record* record : live) {
+                    ofs << record->fields[i] << "\n";
+                }
+            }
+        }
+    } else {
+        // Records
+        for (const Record* record : live) {
+            for (size_t i = 0; i < record->fields.size(); ++i) {
+                // Escape commas in fields
+                std::string field(record->fields[i]);
+                if (field.find(',') != std::string::npos) {
+                    field = "\"" + field + "\"";
+                }
+                ofs << field;
+                if (i != record->fields.size() - 1) ofs << ",";
+            }
+            ofs << "\n";
+        }
+    }
+    Metrics::instance().add(Counter::SAVE_BYTES, static_cast<uint64_t>(ofs.tellp()));
+    ofs.close();
+    uint64_t checksum = fileChecksum(filepath);
+
+    bool zone_map_saved;
+    if (deleted_count == 0) {
+        // In-memory positions match the file: adopt the new encodings
+        encoded = std::move(disk_encoded);
+        encoded_rows = records.size();
+        zone_map_saved = zone_map.save(zoneMapPath(), checksum);
+    } else {
+        ZoneMap live_map;
+        live_map.clear(columns.size());
+        for (const Record* record : live) {
+            live_map.addRow(*record);
+        }
+        zone_map_saved = live_map.save(zoneMapPath(), checksum);
+    }
+    if (!zone_map_saved) {
+        std::cerr << "Error: Unable to write zone map for " << name << ".\n";
+    }
+    if (!saveStats()) {
+        std::cerr << "Error: Unable to write statistics for " << name << ".\n";
+    }
+    if (!saveViews()) {
+        std::cerr << "Error: Unable to write view definitions for " << name << ".\n";
+    }
+
+    // Checkpoint: drop stale bits and resize saturated filters
+    if (blooms_stale) {
+        rebuildBlooms();
+    }
+    if (!saveBloomSettings()) {
+        std::cerr << "Error: Unable to write Bloom filter settings for " << name << ".\n";
+    }
+    saved_version = version;
+}
+
+bool Table::saveBloomSettings() const {
+    if (bloom_columns.empty()) {
+        return true;
+    }
+    std::ofstream bfs(bloomPath(), std::ios::trunc);
+    if (!bfs) {
+        return false;
+    }
+    bfs << bloom_fpr << "\n";
+    for (size_t i = 0; i < bloom_columns.size(); ++i) {
+        bfs << columns[bloom_columns[i]];
+        if (i != bloom_columns.size() - 1) bfs << ",";
+    }
+    bfs << "\n";
+    return true;
+}
+
+void Table::loadBloomSettings() {
+    // Bloom filters are not persisted, only the columns they cover
+    std::ifstream bfs(bloomPath());
+    if (bfs) {
+        std::string fpr_line, cols_line;
+        std::getline(bfs, fpr_line);
+        std::getline(bfs, cols_line);
+        std::vector<std::string> bloom_cols;
+        std::stringstream cols_ss(cols_line);
+        std::string col;
+        while (std::getline(cols_ss, col, ',')) {
+            bloom_cols.push_back(col);
+        }
+        try {
+            setBloomColumns(bloom_cols, std::stod(fpr_line));
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid Bloom filter settings for " << name << ".\n";
+        }
+    }
+}
+
+bool Table::loadPartitions(const std::string& marker_line, std::istream& is) {
+    if (!partition_spec.read(marker_line, is, columns.size())) {
+        return false;
+    }
+    for (size_t i = 0; i < partition_spec.count(); ++i) {
+        std::string partition_name = partitionTableName(partition_spec.name(i));
+        auto partition = std::make_unique<Table>(partition_name);
+        if (partition->columns != columns) {
+            std::cerr << "Error: Partition " << partition_spec.name(i) << " of " << name
+                      << " is missing or corrupt; starting it empty.\n";
+            partition = std::make_unique<Table>(partition_name, columns);
+        }
+        partitions.push_back(std::move(partition));
+    }
+    return true;
+}
+
+bool Table::loadColumnar(std::istream& is, const std::string& marker_line) {
+    std::stringstream marker(marker_line.substr(COLUMNAR_MARKER.size()));
+    size_t rows = 0;
+    if (!(marker >> rows)) return false;
+    std::vector<Record> loaded;
+    loaded.reserve(rows);
+    for (size_t row = 0; row < rows; ++row) {
+        loaded.emplace_back(std::pmr::vector<std::string_view>(columns.size(), row_arena.get()));
+    }
+    std::vector<EncodedColumn> loaded_encoded(columns.size());
+    std::string tag_line, value;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (!std::getline(is, tag_line)) return false;
+        if (tag_line == "COLUMN PLAIN") {
+            for (auto& record : loaded) {
+                if (!std::getline(is, value)) return false;
+                record.fields[i] = pool->intern(value);
+            }
+            continue;
+        }
+        if (!loaded_encoded[i].read(is, tag_line, rows)) return false;
+        // Rows are materialized once; later scans still use the codes.
+        // Dictionary entries are interned once and retained by every row.
+        std::vector<std::string_view> code_views;
+        for (uint32_t code = 0; code < loaded_encoded[i].dictionarySize(); ++code) {
+            code_views.push_back(pool->intern(loaded_encoded[i].decode(code)));
+        }
+        for (size_t row = 0; row < rows; ++row) {
+            if (code_views.empty()) {
+                loaded[row].fields[i] = pool->intern(loaded_encoded[i].valueAt(row));
+            } else {
+                loaded[row].fields[i] = code_views[loaded_encoded[i].codeAt(row)];
+                pool->retain(loaded[row].fields[i]);
+            }
+        }
+        for (std::string_view view : code_views) {
+            pool->release(view);
+        }
+    }
+    records = std::move(loaded);
+    deleted.assign(rows, false);
+    encoded = std::move(loaded_encoded);
+    encoded_rows = rows;
+    return true;
+}
+
+void Table::load() {
+    ScopedLatency latency(Latency::LOAD);
+    Metrics::instance().add(Counter::LOADS);
+    std::ifstream ifs(filepath);
+    if (!ifs) {
+        std::cerr << "Error: Unable to open file " << filepath << " for reading.\n";
+        return;
+    }
+    std::string line;
+    bool is_header = true;
+    bool columnar = false;
+    while (std::getline(ifs, line)) {
+        if (!is_header && records.empty() && line.compare(0, PARTITION_MARKER.size(), PARTITION_MARKER) == 0) {
+            if (!loadPartitions(line, ifs)) {
+                std::cerr << "Error: Corrupt partition spec in " << filepath << ".\n";
+            }
+            break;
+        }
+        if (!is_header && records.empty() && line.compare(0, COLUMNAR_MARKER.size(), COLUMNAR_MARKER) == 0) {
+            columnar = true;
+            if (!loadColumnar(ifs, line)) {
+                std::cerr << "Error: Corrupt encoded data in " << filepath << ".\n";
+            }
+            break;
+        }
+        std::stringstream ss(line);
+        std::string field;
+        std::vector<std::string> fields;
+        bool in_quotes = false;
+        std::string current_field;
+        for (size_t i = 0; i < line.size(); ++i) {
+            char c = line[i];
+            if (c == '"' ) {
+                in_quotes = !in_quotes;
+            }
+            else if (c == ',' && !in_quotes) {
+                fields.push_back(current_field);
+                current_field.clear();
+            }
+            else {
+                current_field += c;
+            }
+        }
+        fields.push_back(current_field);
+
+        if (is_header) {
+            columns = fields;
+            is_header = false;
+        } else {
+            records.push_back(makeRecord(fields));
+            deleted.push_back(false);
+        }
+    }
+    ifs.close();
+    if (!columnar) {
+        encodeColumns();
+    }
+
+    // Reuse persisted zone map if it was built from this very file, else rebuild it
+    if (!zone_map.load(zoneMapPath(), records.size(), columns.size(), fileChecksum(filepath))) {
+        zone_map.rebuild(records, columns.size());
+    }
+
+    // Statistics are only used if they describe exactly these rows
+    stats.load(statsPath(), records.size(), columns.size());
+    loadViews();
+    loadBloomSettings();
+    saved_version = version;
 }
\ No newline at end of file
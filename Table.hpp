@@ -1,45 +1,185 @@
-// Table.hpp
-#ifndef TABLE_HPP
-#define TABLE_HPP
-
-#include "Record.hpp"
-#include <string>
-#include <vector>
-#include <fstream>
-#include <iostream>
-#include <algorithm>
-#include <functional>
-
-class Table {
-private:
-    std::string name;
-    std::vector<std::string> columns;
-    std::vector<Record> records;
-    std::string filepath;
-
-public:
-    Table(const std::string& name, const std::vector<std::string>& columns);
-    Table(const std::string& name); // Load existing table
-
-    void insert(const std::vector<std::string>& fields);
-    void select(const std::vector<std::string>& select_columns, 
-               const std::vector<std::pair<std::string, std::string>>& aggregates,
-               const std::string& where_column = "", 
-               const std::string& where_value = "",
-               const std::vector<std::pair<std::string, std::string>>& order_by = {},
-               const std::vector<std::string>& group_by = {});
-    void update(const std::string& set_column, const std::string& set_value, 
-               const std::string& where_column = "", 
-               const std::string& where_value = "");
-    void deleteRecords(const std::string& where_column = "", const std::string& where_value = "");
-
-    void save();
-    void load();
-    const std::string& getName() const { return name; }
-    const std::vector<std::string>& getColumns() const { return columns; }
-
-    // For transaction backup
-    Table(const Table& other) : name(other.name), columns(other.columns), records(other.records), filepath(other.filepath) {}
-};
-
+// Table.hpp
+#ifndef TABLE_HPP
+#define TABLE_HPP
+
+#include "Record.hpp"
+#include "ZoneMap.hpp"
+#include "BloomFilter.hpp"
+#include "EncodedColumn.hpp"
+#include "QueryContext.hpp"
+#include "StringPool.hpp"
+#include "TableStats.hpp"
+#include "MaterializedView.hpp"
+#include "PartitionSpec.hpp"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+class Table {
+private:
+    std::string name;
+    std::vector<std::string> columns;
+    // Field values, shared with transaction backups (append-only; see compactPool)
+    std::shared_ptr<StringPool> pool = std::make_shared<StringPool>();
+    // Field arrays of this copy's records; declared before records so it outlives them
+    std::unique_ptr<Arena> row_arena = std::make_unique<Arena>();
+    std::vector<Record> records;
+    std::string filepath;
+    ZoneMap zone_map;
+    // Optional per-block Bloom filters for equality lookups
+    std::vector<int> bloom_columns;
+    double bloom_fpr = DEFAULT_BLOOM_FPR;
+    std::vector<std::vector<BloomFilter>> blooms; // blooms[block][i] covers bloom_columns[i]
+    bool blooms_stale = false; // rebuild at next checkpoint
+    // Column encodings chosen at the last checkpoint, valid for rows [0, encoded_rows)
+    std::vector<EncodedColumn> encoded;
+    size_t encoded_rows = 0;
+    // Deleted rows stay in place until VACUUM; scans skip them
+    std::vector<bool> deleted;
+    size_t deleted_count = 0;
+    // Column statistics from ANALYZE, kept current by writes
+    TableStats stats;
+    // Materialized views over this table, maintained by every write
+    std::vector<MaterializedView> views;
+    // Changes on every write, from a counter shared by all tables; a copy
+    // (a transaction backup) keeps the version of the table it copied
+    uint64_t version = nextVersion();
+    uint64_t saved_version = 0; // version last written to disk
+    // PARTITION BY: rows live in child tables named <name>#<partition>; this table holds none
+    PartitionSpec partition_spec;
+    std::vector<std::unique_ptr<Table>> partitions;
+    std::vector<std::string> dropped_partitions; // files removed at the next save
+
+    // Rows of one storage unit (this table or a partition) that a scan matched
+    struct ScanSource {
+        const Table* table = nullptr;
+        std::vector<size_t> rows;
+    };
+
+    static uint64_t nextVersion();
+
+    int columnIndex(const std::string& column) const;
+    Record makeRecord(const std::vector<std::string>& fields);
+    void rebuildStorage();
+    // Rebuild storage if enough pool values are unreferenced and no backup shares the pool
+    bool compactPool();
+    // Appends the row positions matching WHERE where_idx == where_value (all rows if
+    // where_idx < 0). Room for a block's rows is reserved from memory before the block
+    // is scanned; returns 0, or the size of the reservation that failed and stopped the scan.
+    size_t matchingRows(int where_idx, const std::string& where_value, QueryStats* stats, QueryMemory& memory,
+                        std::vector<size_t>& matches) const;
+    // matchingRows over this table or, in parallel, over the partitions the filter can reach
+    size_t scanSources(int where_idx, const std::string& where_value, QueryStats* stats, QueryMemory& memory,
+                       std::vector<ScanSource>& sources) const;
+    // Run write on each partition the filter can reach, in parallel; returns the summed row counts
+    size_t writePartitions(int where_idx, const std::string& where_value, QueryContext& context,
+                           const std::function<size_t(Table&, QueryContext&)>& write);
+    std::string partitionTableName(const std::string& partition) const { return name + "#" + partition; }
+    std::string zoneMapPath() const;
+    std::string bloomPath() const;
+    std::string statsPath() const;
+    std::string viewsPath() const;
+    bool saveViews() const;
+    void loadViews();
+    bool saveBloomSettings() const;
+    void loadBloomSettings();
+    bool loadPartitions(const std::string& marker_line, std::istream& is);
+    void rebuildBlooms();
+    void addToBlooms(size_t row);
+    bool bloomMayContain(size_t block, int column, const std::string& value) const;
+    bool isEncoded(int column) const;
+    std::vector<EncodedColumn> encodeRows(const std::vector<const Record*>& rows) const;
+    void encodeColumns();
+    std::vector<const Record*> liveRows() const;
+    bool loadColumnar(std::istream& is, const std::string& marker_line);
+
+public:
+    // New, unsaved table; its files are written by the first save()
+    Table(const std::string& name, const std::vector<std::string>& columns,
+          const PartitionSpec& partitioning = PartitionSpec());
+    Table(const std::string& name); // Load existing table
+
+    void insert(const std::vector<std::string>& fields, QueryContext* ctx = nullptr);
+    void select(const std::vector<std::string>& select_columns, 
+               const std::vector<std::pair<std::string, std::string>>& aggregates,
+               const std::string& where_column = "", 
+               const std::string& where_value = "",
+               const std::vector<std::pair<std::string, std::string>>& order_by = {},
+               const std::vector<std::string>& group_by = {},
+               QueryContext* ctx = nullptr);
+    // Return the number of rows changed
+    size_t update(const std::string& set_column, const std::string& set_value, 
+               const std::string& where_column = "", 
+               const std::string& where_value = "",
+               QueryContext* ctx = nullptr);
+    size_t deleteRecords(const std::string& where_column = "", const std::string& where_value = "",
+                       QueryContext* ctx = nullptr);
+
+    // EXPLAIN: print the access path / plan without executing
+    bool explainScan(const std::string& where_column, const std::string& where_value,
+                     QueryContext* ctx = nullptr) const;
+    bool explain(const std::vector<std::string>& select_columns,
+                 const std::vector<std::pair<std::string, std::string>>& aggregates,
+                 const std::string& where_column = "",
+                 const std::string& where_value = "",
+                 const std::vector<std::pair<std::string, std::string>>& order_by = {},
+                 const std::vector<std::string>& group_by = {},
+                 QueryContext* ctx = nullptr) const;
+
+    // Gather column statistics over the live rows (ANALYZE)
+    void analyze();
+    bool saveStats() const;
+    const TableStats& getStats() const { return stats; }
+
+    // CREATE MATERIALIZED VIEW over this table; aggregates are (function, column or "*")
+    bool createView(const std::string& view_name, const std::vector<std::string>& group_by,
+                    const std::vector<std::pair<std::string, std::string>>& aggregates,
+                    QueryContext* ctx = nullptr);
+    bool dropView(const std::string& view_name);
+    // REFRESH MATERIALIZED VIEW: recompute the view from the live rows
+    bool refreshView(const std::string& view_name);
+    // Rebuild views whose REAL sums may have drifted; returns whether any was rebuilt
+    bool rebuildDriftedViews();
+    const MaterializedView* getView(const std::string& view_name) const;
+    const std::vector<MaterializedView>& getViews() const { return views; }
+
+    // Partitioning (ALTER TABLE ... ADD/DROP PARTITION)
+    const PartitionSpec& getPartitionSpec() const { return partition_spec; }
+    std::vector<const Table*> getPartitions() const;
+    bool addPartition(const std::string& partition, const std::string& upper_bound, QueryContext* ctx = nullptr);
+    // Detaches the partition; its files are removed at the next save
+    bool dropPartition(const std::string& partition, QueryContext* ctx = nullptr);
+
+    // Drop tombstoned rows and rebuild position-based structures; returns rows reclaimed
+    size_t vacuum();
+    void save();
+    void load();
+    const std::string& getName() const { return name; }
+    const std::vector<std::string>& getColumns() const { return columns; }
+    bool setBloomColumns(const std::vector<std::string>& bloom_cols, double fpr);
+    bool hasBloom(const std::string& column) const;
+    std::string getEncoding(const std::string& column) const;
+    size_t rowCount() const;
+    size_t deletedCount() const;
+    uint64_t getVersion() const { return version; }
+    const StringPool& getPool() const { return *pool; }
+    const Arena& getRowArena() const { return *row_arena; }
+    size_t recordBytes() const { return records.capacity() * sizeof(Record); }
+    // Value pool, row arena and record arrays, partitions included
+    size_t memoryBytes() const;
+    // What a copy for a transaction backup allocates; the value pool is shared, not copied
+    size_t backupBytes() const;
+    size_t diskBytes() const; // .tbl plus its sidecar files
+
+    // For transaction backup
+    Table(const Table& other);
+    // After a ROLLBACK restores this copy: the shared pool's reference counts
+    // still reflect the discarded writes, so count them again from the live rows
+    void recountPool();
+};
+
 #endif // TABLE_HPP
\ No newline at end of file
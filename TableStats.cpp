@@ -0,0 +1,206 @@
+// TableStats.cpp
+#include "TableStats.hpp"
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+void TableStats::analyze(const std::vector<const Record*>& rows, size_t column_count) {
+    analyzed = true;
+    sketches_exact = true;
+    row_count = rows.size();
+    columns.assign(column_count, ColumnStatistics());
+
+    // Single pass: null counts and sketches over every row, plus a reservoir sample of rows
+    std::mt19937_64 rng(rows.size());
+    std::vector<const Record*> sample;
+    sample.reserve(std::min(rows.size(), STATS_SAMPLE_ROWS));
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const Record& record = *rows[i];
+        for (size_t c = 0; c < column_count && c < record.fields.size(); ++c) {
+            if (record.fields[c].empty()) {
+                columns[c].null_count++;
+            } else {
+                columns[c].distinct.add(record.fields[c]);
+            }
+        }
+        if (sample.size() < STATS_SAMPLE_ROWS) {
+            sample.push_back(&record);
+        } else {
+            size_t slot = rng() % (i + 1);
+            if (slot < STATS_SAMPLE_ROWS) sample[slot] = &record;
+        }
+    }
+
+    // Equi-depth bounds at the sample's quantiles; repeated bounds collapse into one bucket
+    for (size_t c = 0; c < column_count; ++c) {
+        ColumnStatistics& column = columns[c];
+        std::vector<std::string_view> values;
+        for (const Record* record : sample) {
+            if (c < record->fields.size() && !record->fields[c].empty()) {
+                values.push_back(record->fields[c]);
+            }
+        }
+        if (values.empty()) continue;
+        std::sort(values.begin(), values.end());
+        std::vector<size_t> sample_counts;
+        size_t previous = 0;
+        for (size_t b = 1; b <= STATS_HISTOGRAM_BUCKETS; ++b) {
+            size_t end = std::max<size_t>(1, b * values.size() / STATS_HISTOGRAM_BUCKETS);
+            // Keep equal values in one bucket
+            end = std::upper_bound(values.begin(), values.end(), values[end - 1]) - values.begin();
+            if (end <= previous) continue;
+            column.bounds.emplace_back(values[end - 1]);
+            sample_counts.push_back(end - previous);
+            previous = end;
+        }
+        // Scale sample counts to the column's non-null rows
+        size_t non_null = row_count - column.null_count;
+        size_t assigned = 0;
+        for (size_t count : sample_counts) {
+            size_t scaled = count * non_null / values.size();
+            column.bucket_counts.push_back(scaled);
+            assigned += scaled;
+        }
+        column.bucket_counts.back() += non_null - assigned;
+    }
+}
+
+size_t TableStats::bucketOf(const ColumnStatistics& column, std::string_view value) const {
+    auto it = std::lower_bound(column.bounds.begin(), column.bounds.end(), value,
+                               [](const std::string& bound, std::string_view v) { return bound < v; });
+    if (it == column.bounds.end()) {
+        return column.bounds.size() - 1;
+    }
+    return it - column.bounds.begin();
+}
+
+void TableStats::addValue(ColumnStatistics& column, std::string_view value) {
+    if (value.empty()) {
+        column.null_count++;
+        return;
+    }
+    column.distinct.add(value);
+    if (column.bounds.empty()) {
+        column.bounds.emplace_back(value);
+        column.bucket_counts.push_back(0);
+    } else if (value > column.bounds.back()) {
+        column.bounds.back() = std::string(value); // widen the last bucket
+    }
+    column.bucket_counts[bucketOf(column, value)]++;
+}
+
+void TableStats::removeValue(ColumnStatistics& column, std::string_view value) {
+    sketches_exact = false;
+    if (value.empty()) {
+        if (column.null_count > 0) column.null_count--;
+        return;
+    }
+    if (column.bounds.empty()) return;
+    size_t& count = column.bucket_counts[bucketOf(column, value)];
+    if (count > 0) count--; // bucket counts from ANALYZE are estimates
+}
+
+void TableStats::addRow(const Record& record) {
+    if (!analyzed) return;
+    row_count++;
+    for (size_t c = 0; c < columns.size() && c < record.fields.size(); ++c) {
+        addValue(columns[c], record.fields[c]);
+    }
+}
+
+void TableStats::removeRow(const Record& record) {
+    if (!analyzed) return;
+    if (row_count > 0) row_count--;
+    for (size_t c = 0; c < columns.size() && c < record.fields.size(); ++c) {
+        removeValue(columns[c], record.fields[c]);
+    }
+}
+
+void TableStats::updateValue(size_t column, std::string_view old_value, std::string_view new_value) {
+    if (!analyzed || column >= columns.size()) return;
+    removeValue(columns[column], old_value);
+    addValue(columns[column], new_value);
+}
+
+double TableStats::nullFraction(size_t column) const {
+    return row_count ? static_cast<double>(columns[column].null_count) / row_count : 0.0;
+}
+
+double TableStats::estimateEqual(size_t column, std::string_view value) const {
+    const ColumnStatistics& stats = columns[column];
+    if (value.empty()) {
+        return static_cast<double>(stats.null_count);
+    }
+    if (stats.bounds.empty() || value > stats.bounds.back()) {
+        return 0.0;
+    }
+    // Assume distinct values are spread evenly over the buckets
+    double distinct_per_bucket = std::max(1.0, static_cast<double>(stats.distinct.estimate()) / stats.bounds.size());
+    return stats.bucket_counts[bucketOf(stats, value)] / distinct_per_bucket;
+}
+
+bool TableStats::save(const std::string& path) const {
+    std::ofstream ofs(path, std::ios::trunc);
+    if (!ofs) {
+        return false;
+    }
+    ofs << "STATS " << row_count << " " << columns.size() << " " << (sketches_exact ? 1 : 0) << "\n";
+    for (const auto& column : columns) {
+        ofs << column.null_count << " " << column.bounds.size() << " "
+            << column.distinct.getPrecision() << " " << column.distinct.serialize() << "\n";
+        for (size_t b = 0; b < column.bounds.size(); ++b) {
+            ofs << column.bucket_counts[b] << " " << column.bounds[b].size() << " " << column.bounds[b] << "\n";
+        }
+    }
+    return true;
+}
+
+bool TableStats::load(const std::string& path, size_t expected_rows, size_t column_count) {
+    std::ifstream ifs(path);
+    if (!ifs) {
+        return false;
+    }
+    std::string line, magic;
+    if (!std::getline(ifs, line)) {
+        return false;
+    }
+    std::stringstream header(line);
+    size_t rows = 0, cols = 0;
+    int exact = 0;
+    header >> magic >> rows >> cols >> exact;
+    if (magic != "STATS" || rows != expected_rows || cols != column_count) {
+        return false;
+    }
+
+    std::vector<ColumnStatistics> loaded(cols);
+    for (auto& column : loaded) {
+        size_t bucket_count = 0;
+        unsigned precision = 0;
+        std::string hex;
+        if (!std::getline(ifs, line)) return false;
+        std::stringstream ss(line);
+        if (!(ss >> column.null_count >> bucket_count >> precision >> hex) || precision < 4 || precision > 18) {
+            return false;
+        }
+        column.distinct = HyperLogLog(precision);
+        if (!column.distinct.deserialize(hex)) return false;
+        for (size_t b = 0; b < bucket_count; ++b) {
+            if (!std::getline(ifs, line)) return false;
+            std::stringstream bs(line);
+            size_t count = 0, length = 0;
+            if (!(bs >> count >> length)) return false;
+            bs.get(); // separator
+            std::string bound;
+            std::getline(bs, bound);
+            if (bound.size() != length) return false;
+            column.bucket_counts.push_back(count);
+            column.bounds.push_back(bound);
+        }
+    }
+    analyzed = true;
+    sketches_exact = exact != 0;
+    row_count = rows;
+    columns = std::move(loaded);
+    return true;
+}
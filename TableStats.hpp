@@ -0,0 +1,63 @@
+// TableStats.hpp
+#ifndef TABLESTATS_HPP
+#define TABLESTATS_HPP
+
+#include "HyperLogLog.hpp"
+#include "Record.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+const size_t STATS_HISTOGRAM_BUCKETS = 32;
+// Rows sampled (reservoir) to place histogram bucket bounds
+const size_t STATS_SAMPLE_ROWS = 8192;
+
+// Statistics for one column. Empty fields are nulls and are kept out of
+// the histogram and the distinct count.
+struct ColumnStatistics {
+    size_t null_count = 0;
+    HyperLogLog distinct;
+    std::vector<std::string> bounds;   // inclusive upper bound of each equi-depth bucket
+    std::vector<size_t> bucket_counts; // non-null rows per bucket
+};
+
+// Gathered by ANALYZE in one pass over the live rows, then kept current on
+// insert, update and delete. Sketches cannot forget values, so after an
+// update or delete distinct counts may overestimate until the next ANALYZE.
+class TableStats {
+private:
+    bool analyzed = false;
+    bool sketches_exact = true; // no value removed since ANALYZE
+    size_t row_count = 0;
+    std::vector<ColumnStatistics> columns;
+
+    size_t bucketOf(const ColumnStatistics& column, std::string_view value) const;
+    void addValue(ColumnStatistics& column, std::string_view value);
+    void removeValue(ColumnStatistics& column, std::string_view value);
+
+public:
+    TableStats() = default;
+
+    void analyze(const std::vector<const Record*>& rows, size_t column_count);
+    void clear() { *this = TableStats(); }
+
+    // Incremental maintenance; no-ops until the table has been analyzed
+    void addRow(const Record& record);
+    void removeRow(const Record& record);
+    void updateValue(size_t column, std::string_view old_value, std::string_view new_value);
+
+    bool isAnalyzed() const { return analyzed; }
+    bool sketchesExact() const { return sketches_exact; }
+    size_t rowCount() const { return row_count; }
+    const ColumnStatistics& column(size_t index) const { return columns[index]; }
+    double nullFraction(size_t column) const;
+    uint64_t distinctEstimate(size_t column) const { return columns[column].distinct.estimate(); }
+    // Estimated rows with column == value
+    double estimateEqual(size_t column, std::string_view value) const;
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path, size_t expected_rows, size_t column_count);
+};
+
+#endif // TABLESTATS_HPP
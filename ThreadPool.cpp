@@ -0,0 +1,82 @@
+// ThreadPool.cpp
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool() {
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 1; i < cores; ++i) {
+        workers.emplace_back([this]() { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::work() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t max_threads, const std::function<void(size_t)>& fn) {
+    size_t helpers = std::min({count, max_threads, workers.size() + 1});
+    helpers = helpers > 0 ? helpers - 1 : 0;
+    if (helpers == 0) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+    // Helpers that start late find nothing left, so the loop state outlives this call
+    struct Loop {
+        std::atomic<size_t> next{0};
+        size_t finished = 0;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto loop = std::make_shared<Loop>();
+    size_t total = count;
+    const std::function<void(size_t)>* body = &fn;
+    auto run = [loop, total, body]() {
+        size_t ran = 0;
+        for (size_t i = loop->next++; i < total; i = loop->next++) {
+            (*body)(i);
+            ran++;
+        }
+        if (ran == 0) return; // fn may be gone already
+        std::lock_guard<std::mutex> lock(loop->mutex);
+        loop->finished += ran;
+        if (loop->finished == total) loop->done.notify_all();
+    };
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < helpers; ++i) {
+            tasks.push_back(run);
+        }
+    }
+    wake.notify_all();
+    run();
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->done.wait(lock, [&]() { return loop->finished == total; });
+}
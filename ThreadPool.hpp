@@ -0,0 +1,40 @@
+// ThreadPool.hpp
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+// Worker threads shared by every statement, one per core less the caller,
+// started on first use and kept until exit. parallelFor runs the loop on
+// the calling thread too, so it finishes even when every worker is busy
+// with other statements.
+class ThreadPool {
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    ThreadPool();
+    void work();
+
+public:
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static ThreadPool& instance();
+
+    size_t workerCount() const { return workers.size(); }
+    // Run fn(0) .. fn(count - 1) on the caller and up to max_threads - 1 workers
+    void parallelFor(size_t count, size_t max_threads, const std::function<void(size_t)>& fn);
+};
+
+#endif // THREADPOOL_HPP
@@ -0,0 +1,131 @@
+// ZoneMap.cpp
+#include "ZoneMap.hpp"
+#include <fstream>
+#include <sstream>
+
+void ZoneMap::clear(size_t columns) {
+    column_count = columns;
+    row_count = 0;
+    blocks.clear();
+}
+
+void ZoneMap::rebuild(const std::vector<Record>& records, size_t columns) {
+    clear(columns);
+    for (const auto& record : records) {
+        addRow(record);
+    }
+}
+
+void ZoneMap::addValue(ColumnZone& zone, std::string_view value) {
+    if (value.empty()) {
+        zone.null_count++;
+        return;
+    }
+    if (zone.value_count == 0) {
+        zone.min = value;
+        zone.max = value;
+    } else {
+        if (value < zone.min) zone.min = value;
+        if (value > zone.max) zone.max = value;
+    }
+    zone.value_count++;
+}
+
+void ZoneMap::addRow(const Record& record) {
+    if (row_count % ZONE_BLOCK_ROWS == 0) {
+        blocks.emplace_back(column_count);
+    }
+    auto& block = blocks.back();
+    for (size_t i = 0; i < column_count && i < record.fields.size(); ++i) {
+        addValue(block[i], record.fields[i]);
+    }
+    row_count++;
+}
+
+void ZoneMap::updateValue(size_t row, size_t column, std::string_view old_value, std::string_view new_value) {
+    size_t block = row / ZONE_BLOCK_ROWS;
+    if (block >= blocks.size() || column >= column_count) return;
+    ColumnZone& zone = blocks[block][column];
+    // Min/max only ever widen here; they may be loose until the next rebuild
+    if (old_value.empty()) {
+        zone.null_count--;
+    } else {
+        zone.value_count--;
+    }
+    addValue(zone, new_value);
+}
+
+bool ZoneMap::mayContain(size_t block, size_t column, const std::string& value) const {
+    if (block >= blocks.size() || column >= column_count) return true;
+    const ColumnZone& zone = blocks[block][column];
+    if (value.empty()) {
+        return zone.null_count > 0;
+    }
+    if (zone.value_count == 0) {
+        return false;
+    }
+    return !(value < zone.min || value > zone.max);
+}
+
+bool ZoneMap::save(const std::string& path, uint64_t data_checksum) const {
+    std::ofstream ofs(path, std::ios::trunc);
+    if (!ofs) {
+        return false;
+    }
+    ofs << "ZMAP " << ZONE_BLOCK_ROWS << " " << row_count << " " << column_count << " " << blocks.size()
+        << " " << data_checksum << "\n";
+    for (const auto& block : blocks) {
+        for (const auto& zone : block) {
+            ofs << zone.null_count << " " << zone.value_count << " "
+                << zone.min.size() << " " << zone.max.size() << " "
+                << zone.min << zone.max << "\n";
+        }
+    }
+    return true;
+}
+
+bool ZoneMap::load(const std::string& path, size_t expected_rows, size_t columns, uint64_t data_checksum) {
+    std::ifstream ifs(path);
+    if (!ifs) {
+        return false;
+    }
+    std::string line;
+    if (!std::getline(ifs, line)) {
+        return false;
+    }
+    std::stringstream header(line);
+    std::string magic;
+    size_t block_rows = 0, rows = 0, cols = 0, block_count = 0;
+    uint64_t checksum = 0;
+    header >> magic >> block_rows >> rows >> cols >> block_count >> checksum;
+    if (magic != "ZMAP" || block_rows != ZONE_BLOCK_ROWS || rows != expected_rows || cols != columns ||
+        block_count != (rows + ZONE_BLOCK_ROWS - 1) / ZONE_BLOCK_ROWS || !header || checksum != data_checksum) {
+        return false;
+    }
+
+    std::vector<std::vector<ColumnZone>> loaded(block_count, std::vector<ColumnZone>(cols));
+    for (auto& block : loaded) {
+        for (auto& zone : block) {
+            if (!std::getline(ifs, line)) {
+                return false;
+            }
+            std::stringstream ss(line);
+            size_t min_len = 0, max_len = 0;
+            if (!(ss >> zone.null_count >> zone.value_count >> min_len >> max_len)) {
+                return false;
+            }
+            ss.get(); // separator
+            std::string rest;
+            std::getline(ss, rest);
+            if (rest.size() != min_len + max_len) {
+                return false;
+            }
+            zone.min = rest.substr(0, min_len);
+            zone.max = rest.substr(min_len);
+        }
+    }
+    column_count = cols;
+    row_count = rows;
+    blocks = std::move(loaded);
+    return true;
+}
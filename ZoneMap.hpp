@@ -0,0 +1,52 @@
+// ZoneMap.hpp
+#ifndef ZONEMAP_HPP
+#define ZONEMAP_HPP
+
+#include "Record.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+// Number of rows summarized by one zone-map block
+const size_t ZONE_BLOCK_ROWS = 65536;
+
+// Summary of one column within one block.
+// Empty fields are treated as nulls and are kept out of min/max.
+struct ColumnZone {
+    std::string min;
+    std::string max;
+    size_t null_count = 0;
+    size_t value_count = 0; // non-null values
+};
+
+class ZoneMap {
+private:
+    size_t column_count = 0;
+    size_t row_count = 0;
+    std::vector<std::vector<ColumnZone>> blocks; // blocks[block][column]
+
+    void addValue(ColumnZone& zone, std::string_view value);
+
+public:
+    ZoneMap() = default;
+
+    void clear(size_t columns);
+    void rebuild(const std::vector<Record>& records, size_t columns);
+    void addRow(const Record& record);
+    void updateValue(size_t row, size_t column, std::string_view old_value, std::string_view new_value);
+
+    // False only if no row of the block can have column == value
+    bool mayContain(size_t block, size_t column, const std::string& value) const;
+
+    size_t blockCount() const { return blocks.size(); }
+    size_t rowCount() const { return row_count; }
+
+    // data_checksum identifies the data file the map was built from: a map saved
+    // beside an older or newer data file (a crash between the two writes) is refused
+    bool save(const std::string& path, uint64_t data_checksum) const;
+    bool load(const std::string& path, size_t expected_rows, size_t columns, uint64_t data_checksum);
+};
+
+#endif // ZONEMAP_HPP
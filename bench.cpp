@@ -0,0 +1,304 @@
+// bench.cpp
+// Micro/macro benchmark harness for Table and Database.
+// Usage: minidb_bench [--rows N] [--columns N] [--cardinality N] [--iterations N]
+//                     [--seed N] [--label NAME] [--json FILE] [--dir DIR]
+#include "Database.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct BenchConfig {
+    size_t rows = 100000;
+    size_t columns = 4;
+    size_t cardinality = 100; // distinct values per non-key column
+    size_t iterations = 20;
+    unsigned long long seed = 42;
+    std::string label = "dev";
+    std::string json_path = "bench_results.json";
+    std::string dir; // empty: temporary directory, removed afterwards
+};
+
+struct BenchResult {
+    std::string name;
+    size_t rows_per_op = 0;
+    double total_seconds = 0.0;
+    std::vector<double> latencies_us;
+};
+
+// Swallows the tables' console output while timing
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+class Silence {
+private:
+    NullBuffer null_buffer;
+    std::streambuf* saved_out;
+    std::streambuf* saved_err;
+
+public:
+    Silence() : saved_out(std::cout.rdbuf(&null_buffer)), saved_err(std::cerr.rdbuf(&null_buffer)) {}
+    ~Silence() {
+        std::cout.rdbuf(saved_out);
+        std::cerr.rdbuf(saved_err);
+    }
+};
+
+using Clock = std::chrono::steady_clock;
+
+template <typename F>
+double timeUs(F&& op) {
+    auto start = Clock::now();
+    op();
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+template <typename F>
+BenchResult runTimed(const std::string& name, size_t iterations, size_t rows_per_op, F&& op) {
+    BenchResult result;
+    result.name = name;
+    result.rows_per_op = rows_per_op;
+    for (size_t i = 0; i < iterations; ++i) {
+        double us = timeUs(op);
+        result.latencies_us.push_back(us);
+        result.total_seconds += us / 1e6;
+    }
+    return result;
+}
+
+double percentile(std::vector<double> samples, double p) {
+    if (samples.empty()) return 0.0;
+    std::sort(samples.begin(), samples.end());
+    size_t idx = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+    return samples[idx];
+}
+
+std::vector<std::string> makeColumns(size_t count) {
+    std::vector<std::string> columns;
+    for (size_t i = 0; i < count; ++i) {
+        columns.push_back("c" + std::to_string(i));
+    }
+    return columns;
+}
+
+// c0 is a unique key, every other column draws from `cardinality` values
+std::vector<std::vector<std::string>> makeRows(const BenchConfig& config) {
+    std::mt19937_64 rng(config.seed);
+    std::uniform_int_distribution<size_t> pick(0, config.cardinality - 1);
+    std::vector<std::vector<std::string>> rows(config.rows);
+    for (size_t r = 0; r < config.rows; ++r) {
+        rows[r].push_back(std::to_string(r));
+        for (size_t c = 1; c < config.columns; ++c) {
+            rows[r].push_back("v" + std::to_string(pick(rng)));
+        }
+    }
+    return rows;
+}
+
+void printResult(const BenchResult& result) {
+    size_t ops = result.latencies_us.size();
+    double ops_per_s = result.total_seconds > 0 ? ops / result.total_seconds : 0.0;
+    std::cout << std::left << std::setw(18) << result.name
+              << std::right << std::setw(10) << ops
+              << std::setw(12) << std::fixed << std::setprecision(4) << result.total_seconds
+              << std::setw(14) << std::setprecision(1) << ops_per_s
+              << std::setw(14) << ops_per_s * result.rows_per_op
+              << std::setw(12) << std::setprecision(1) << percentile(result.latencies_us, 0.50)
+              << std::setw(12) << percentile(result.latencies_us, 0.99) << "\n";
+}
+
+void writeJson(std::ostream& os, const BenchConfig& config, const BenchResult& result) {
+    size_t ops = result.latencies_us.size();
+    double ops_per_s = result.total_seconds > 0 ? ops / result.total_seconds : 0.0;
+    os << std::fixed << std::setprecision(3)
+       << "{\"label\":\"" << config.label << "\""
+       << ",\"benchmark\":\"" << result.name << "\""
+       << ",\"rows\":" << config.rows
+       << ",\"columns\":" << config.columns
+       << ",\"cardinality\":" << config.cardinality
+       << ",\"ops\":" << ops
+       << ",\"total_s\":" << result.total_seconds
+       << ",\"ops_per_s\":" << ops_per_s
+       << ",\"rows_per_s\":" << ops_per_s * result.rows_per_op
+       << ",\"p50_us\":" << percentile(result.latencies_us, 0.50)
+       << ",\"p99_us\":" << percentile(result.latencies_us, 0.99)
+       << "}\n";
+}
+
+bool parseArgs(int argc, char** argv, BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Missing value for " << arg << ".\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "--rows") config.rows = std::stoull(value);
+            else if (arg == "--columns") config.columns = std::stoull(value);
+            else if (arg == "--cardinality") config.cardinality = std::stoull(value);
+            else if (arg == "--iterations") config.iterations = std::stoull(value);
+            else if (arg == "--seed") config.seed = std::stoull(value);
+            else if (arg == "--label") config.label = value;
+            else if (arg == "--json") config.json_path = value;
+            else if (arg == "--dir") config.dir = value;
+            else {
+                std::cerr << "Error: Unknown option " << arg << ".\n";
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid value for " << arg << ".\n";
+            return false;
+        }
+    }
+    if (config.rows == 0 || config.columns < 2 || config.cardinality == 0 || config.iterations == 0) {
+        std::cerr << "Error: rows, cardinality and iterations must be positive and columns at least 2.\n";
+        return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        return 1;
+    }
+
+    // Tables always live in ./data, so run inside a scratch directory
+    fs::path json_path = fs::absolute(config.json_path);
+    fs::path work_dir = config.dir.empty()
+        ? fs::temp_directory_path() / ("minidb_bench_" + std::to_string(std::random_device{}()))
+        : fs::absolute(config.dir);
+    fs::create_directories(work_dir / "data");
+    fs::path original_dir = fs::current_path();
+    fs::current_path(work_dir);
+
+    std::vector<std::string> columns = makeColumns(config.columns);
+    std::vector<std::vector<std::string>> rows = makeRows(config);
+    std::mt19937_64 rng(config.seed + 1);
+    std::uniform_int_distribution<size_t> pick(0, config.cardinality - 1);
+    std::vector<BenchResult> results;
+
+    {
+        Silence silence;
+
+        // Ingest: one timed insert per row
+        Table table("bench", columns);
+        BenchResult ingest;
+        ingest.name = "insert";
+        ingest.rows_per_op = 1;
+        for (const auto& row : rows) {
+            double us = timeUs([&] { table.insert(row); });
+            ingest.latencies_us.push_back(us);
+            ingest.total_seconds += us / 1e6;
+        }
+        results.push_back(ingest);
+
+        results.push_back(runTimed("save", config.iterations, config.rows, [&] { table.save(); }));
+        results.push_back(runTimed("load", config.iterations, config.rows, [&] { Table loaded("bench"); }));
+
+        std::vector<std::pair<std::string, std::string>> no_aggregates;
+        results.push_back(runTimed("select_all", config.iterations, config.rows, [&] {
+            table.select({}, no_aggregates);
+        }));
+        results.push_back(runTimed("select_where", config.iterations, config.rows, [&] {
+            table.select({}, no_aggregates, "c1", "v" + std::to_string(pick(rng)));
+        }));
+        results.push_back(runTimed("select_key", config.iterations, config.rows, [&] {
+            table.select({}, no_aggregates, "c0", std::to_string(rng() % config.rows));
+        }));
+        results.push_back(runTimed("select_order_by", config.iterations, config.rows, [&] {
+            table.select({"c0", "c1"}, no_aggregates, "", "", {{"c1", "DESC"}, {"c0", "ASC"}});
+        }));
+        results.push_back(runTimed("select_group_by", config.iterations, config.rows, [&] {
+            table.select({"c1"}, {{"COUNT", "*"}}, "", "", {}, {"c1"});
+        }));
+
+        // Transactions go through Database, which backs up a table on the
+        // transaction's first write to it; that write is timed with BEGIN
+        Database db;
+        db.createTable("bench_txn", columns);
+        Table* txn_table = db.getTable("bench_txn");
+        for (const auto& row : rows) {
+            txn_table->insert(row);
+        }
+        std::ostringstream txn_output;
+        Session session(txn_output, txn_output);
+        BenchResult begin, commit, rollback;
+        begin.name = "txn_begin";
+        commit.name = "txn_commit";
+        rollback.name = "txn_rollback";
+        begin.rows_per_op = commit.rows_per_op = rollback.rows_per_op = config.rows;
+        for (size_t i = 0; i < config.iterations; ++i) {
+            std::string write = i % 2 == 0
+                ? "UPDATE bench_txn SET c1 = changed WHERE c0 " + std::to_string(i)
+                : "DELETE FROM bench_txn WHERE c1 v" + std::to_string(pick(rng));
+            double us = timeUs([&] {
+                db.execute("BEGIN TRANSACTION", session);
+                db.execute(write, session);
+            });
+            begin.latencies_us.push_back(us);
+            begin.total_seconds += us / 1e6;
+            if (i % 2 == 0) {
+                us = timeUs([&] { db.execute("COMMIT", session); });
+                commit.latencies_us.push_back(us);
+                commit.total_seconds += us / 1e6;
+            } else {
+                us = timeUs([&] { db.execute("ROLLBACK", session); });
+                rollback.latencies_us.push_back(us);
+                rollback.total_seconds += us / 1e6;
+            }
+        }
+        results.push_back(begin);
+        results.push_back(commit);
+        if (!rollback.latencies_us.empty()) {
+            results.push_back(rollback);
+        }
+    }
+
+    fs::current_path(original_dir);
+    if (config.dir.empty()) {
+        fs::remove_all(work_dir);
+    }
+
+    std::cout << "MiniDB benchmark '" << config.label << "': " << config.rows << " rows, "
+              << config.columns << " columns, cardinality " << config.cardinality
+              << ", " << config.iterations << " iterations\n";
+    std::cout << std::left << std::setw(18) << "benchmark"
+              << std::right << std::setw(10) << "ops"
+              << std::setw(12) << "total_s"
+              << std::setw(14) << "ops/s"
+              << std::setw(14) << "rows/s"
+              << std::setw(12) << "p50_us"
+              << std::setw(12) << "p99_us" << "\n";
+    for (const auto& result : results) {
+        printResult(result);
+    }
+
+    // One JSON object per line, appended so runs of different versions can be diffed
+    std::ofstream json(json_path, std::ios::app);
+    if (!json) {
+        std::cerr << "Error: Unable to open " << json_path << " for writing.\n";
+        return 1;
+    }
+    for (const auto& result : results) {
+        writeJson(json, config, result);
+    }
+    std::cout << "Results appended to " << json_path.string() << "\n";
+    return 0;
+}
@@ -1,16 +1,90 @@
-// main.cpp
-#include "Database.hpp"
-#include <filesystem>
-#include <iostream>
-
-int main() {
-    // Create data directory if it doesn't exist
-    std::string data_dir = "data";
-    if (!std::filesystem::exists(data_dir)) {
-        std::filesystem::create_directory(data_dir);
-    }
-
-    Database db;
-    db.run();
-    return 0;
-}
\ No newline at end of file
+// main.cpp
+#include "Database.hpp"
+#include "Metrics.hpp"
+#include "MemoryTracker.hpp"
+#include "Server.hpp"
+#include <csignal>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+static Server* running_server = nullptr;
+
+static void stopServer(int) {
+    if (running_server) running_server->requestStop();
+}
+
+int main(int argc, char** argv) {
+    // Optional: --server SOCKET_PATH, --metrics-file PATH [--metrics-interval SECONDS], --memory-limit BYTES
+    std::string socket_path;
+    std::string metrics_file;
+    double metrics_interval = 10.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--server" && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (arg == "--metrics-file" && i + 1 < argc) {
+            metrics_file = argv[++i];
+        } else if (arg == "--metrics-interval" && i + 1 < argc) {
+            try {
+                metrics_interval = std::stod(argv[++i]);
+            } catch (const std::exception&) {
+                metrics_interval = 0.0;
+            }
+            if (metrics_interval <= 0.0) {
+                std::cerr << "Error: --metrics-interval must be a positive number of seconds.\n";
+                return 1;
+            }
+        } else if (arg == "--memory-limit" && i + 1 < argc) {
+            std::string value = argv[++i];
+            size_t parsed = 0;
+            unsigned long long bytes = 0;
+            try {
+                bytes = std::stoull(value, &parsed);
+            } catch (const std::exception&) {
+                parsed = 0;
+            }
+            if (parsed == 0 || parsed != value.size()) {
+                std::cerr << "Error: --memory-limit must be a number of bytes (0 for none).\n";
+                return 1;
+            }
+            MemoryTracker::instance().setLimit(bytes);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--server SOCKET_PATH] [--metrics-file PATH] [--metrics-interval SECONDS]"
+                      << " [--memory-limit BYTES]\n";
+            return 1;
+        }
+    }
+
+    // Create data directory if it doesn't exist
+    std::string data_dir = "data";
+    if (!std::filesystem::exists(data_dir)) {
+        std::filesystem::create_directory(data_dir);
+    }
+
+    if (!metrics_file.empty() && !Metrics::instance().startDump(metrics_file, metrics_interval)) {
+        std::cerr << "Error: Unable to write metrics to " << metrics_file << ".\n";
+        return 1;
+    }
+
+    Database db;
+    if (socket_path.empty()) {
+        db.run();
+    } else {
+        db.autoLoadTables();
+        Server server(db, socket_path);
+        if (!server.start(std::cerr)) {
+            Metrics::instance().stopDump();
+            return 1;
+        }
+        running_server = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        std::cout << "MiniDB listening on " << socket_path << "\n";
+        server.run();
+        running_server = nullptr;
+        std::cout << "MiniDB server stopped.\n";
+    }
+    Metrics::instance().stopDump();
+    return 0;
+}
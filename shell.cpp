@@ -0,0 +1,35 @@
+// shell.cpp
+// Interactive client for a MiniDB server.
+// Usage: minidb_shell SOCKET_PATH
+#include "Client.hpp"
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " SOCKET_PATH\n";
+        return 1;
+    }
+    Client client;
+    std::string error;
+    if (!client.connect(argv[1], &error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    std::string input;
+    std::cout << "Connected to MiniDB at " << argv[1] << ". Enter SQL commands or 'exit' to quit.\n";
+    while (true) {
+        std::cout << "MiniDB> ";
+        if (!std::getline(std::cin, input)) break;
+        if (input.empty()) continue;
+        if (input == "exit") break;
+        ClientResult result = client.execute(input);
+        std::cout << result.output;
+        std::cerr << result.error;
+        if (!result.delivered) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,365 @@
+// ycsb.cpp
+// YCSB-style workload driver: loads a usertable, then runs a read/update/insert
+// mix from N client threads against the Table API and reports per-operation
+// latency histograms and throughput scaling.
+// Usage: minidb_ycsb [--records N] [--threads 1,2,4,8] [--duration SEC | --operations N]
+//                    [--read R] [--update U] [--insert I] [--distribution zipfian|uniform]
+//                    [--theta T] [--fields N] [--field-length N] [--seed N] [--json FILE]
+#include "Database.hpp"
+#include "Histogram.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct WorkloadConfig {
+    size_t records = 100000;
+    std::vector<size_t> thread_counts = {1, 2, 4, 8};
+    double duration = 5.0;  // seconds per thread count
+    size_t operations = 0;  // if set, overrides duration
+    double read_proportion = 0.95;
+    double update_proportion = 0.05;
+    double insert_proportion = 0.0;
+    bool zipfian = true;
+    double theta = 0.99;
+    size_t fields = 10;
+    size_t field_length = 20;
+    unsigned long long seed = 42;
+    std::string json_path = "ycsb_results.json";
+};
+
+enum OpType { OP_READ, OP_UPDATE, OP_INSERT, OP_COUNT };
+const char* OP_NAMES[OP_COUNT] = {"READ", "UPDATE", "INSERT"};
+
+// Zipfian over [0, n) as in YCSB (Gray et al.), scrambled so hot keys
+// are spread over the key space instead of clustered at the front
+class ZipfianGenerator {
+private:
+    uint64_t items;
+    double theta, zetan, alpha, eta;
+
+    static double zeta(uint64_t n, double theta) {
+        double sum = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), theta);
+        }
+        return sum;
+    }
+
+public:
+    ZipfianGenerator(uint64_t items, double theta) : items(items), theta(theta) {
+        zetan = zeta(items, theta);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1 - std::pow(2.0 / items, 1 - theta)) / (1 - zeta(2, theta) / zetan);
+    }
+
+    template <typename Rng>
+    uint64_t next(Rng& rng) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        double uz = u * zetan;
+        uint64_t rank;
+        if (uz < 1.0) rank = 0;
+        else if (uz < 1.0 + std::pow(0.5, theta)) rank = 1;
+        else rank = static_cast<uint64_t>(items * std::pow(eta * u - eta + 1, alpha));
+        // FNV-1a scramble
+        uint64_t h = 14695981039346656037ULL;
+        for (int i = 0; i < 8; ++i) {
+            h ^= (rank >> (i * 8)) & 0xff;
+            h *= 1099511628211ULL;
+        }
+        return h % items;
+    }
+};
+
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+std::string makeKey(uint64_t id) {
+    std::ostringstream ss;
+    ss << "user" << std::setw(10) << std::setfill('0') << id;
+    return ss.str();
+}
+
+template <typename Rng>
+std::string randomValue(Rng& rng, size_t length) {
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyz";
+    std::string value(length, 'a');
+    for (auto& c : value) {
+        c = letters[rng() % 26];
+    }
+    return value;
+}
+
+struct PhaseResult {
+    size_t threads = 0;
+    double seconds = 0.0;
+    Histogram histograms[OP_COUNT];
+
+    uint64_t totalOps() const {
+        uint64_t ops = 0;
+        for (const auto& h : histograms) ops += h.count();
+        return ops;
+    }
+    double throughput() const { return seconds > 0 ? totalOps() / seconds : 0.0; }
+};
+
+PhaseResult runPhase(const WorkloadConfig& config, Table* table, std::shared_mutex& table_lock,
+                     std::atomic<uint64_t>& next_key, size_t thread_count) {
+    PhaseResult result;
+    result.threads = thread_count;
+    std::vector<PhaseResult> per_thread(thread_count);
+    std::atomic<bool> stop{false};
+    uint64_t key_space = config.records;
+    size_t ops_per_thread = config.operations / thread_count;
+
+    auto client = [&](size_t id) {
+        std::mt19937_64 rng(config.seed * 1000 + thread_count * 100 + id);
+        ZipfianGenerator zipf(key_space, config.theta);
+        std::uniform_int_distribution<uint64_t> uniform(0, key_space - 1);
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+        NullBuffer null_buffer;
+        std::ostream null_stream(&null_buffer);
+        QueryContext ctx(null_stream, null_stream);
+        Histogram* histograms = per_thread[id].histograms;
+
+        for (size_t done = 0; config.operations ? done < ops_per_thread : !stop.load(std::memory_order_relaxed); ++done) {
+            double pick = coin(rng);
+            OpType op = pick < config.read_proportion ? OP_READ
+                      : pick < config.read_proportion + config.update_proportion ? OP_UPDATE
+                      : OP_INSERT;
+            std::string key = makeKey(config.zipfian ? zipf.next(rng) : uniform(rng));
+            ctx.stats = QueryStats();
+            auto start = std::chrono::steady_clock::now();
+            if (op == OP_READ) {
+                std::shared_lock<std::shared_mutex> lock(table_lock);
+                table->select({}, {}, "ycsb_key", key, {}, {}, &ctx);
+            } else if (op == OP_UPDATE) {
+                std::string field = "field" + std::to_string(rng() % config.fields);
+                std::string value = randomValue(rng, config.field_length);
+                std::unique_lock<std::shared_mutex> lock(table_lock);
+                table->update(field, value, "ycsb_key", key, &ctx);
+            } else {
+                std::vector<std::string> row = {makeKey(next_key++)};
+                for (size_t f = 0; f < config.fields; ++f) {
+                    row.push_back(randomValue(rng, config.field_length));
+                }
+                std::unique_lock<std::shared_mutex> lock(table_lock);
+                table->insert(row, &ctx);
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            histograms[op].record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back(client, i);
+    }
+    if (!config.operations) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(config.duration));
+        stop = true;
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& thread_result : per_thread) {
+        for (int op = 0; op < OP_COUNT; ++op) {
+            result.histograms[op].merge(thread_result.histograms[op]);
+        }
+    }
+    return result;
+}
+
+void printPhase(const PhaseResult& result, double baseline) {
+    std::cout << "threads=" << result.threads
+              << " ops=" << result.totalOps()
+              << std::fixed << std::setprecision(2)
+              << " duration=" << result.seconds << "s"
+              << " throughput=" << std::setprecision(1) << result.throughput() << " ops/s"
+              << " speedup=" << std::setprecision(2) << (baseline > 0 ? result.throughput() / baseline : 1.0) << "x\n";
+    std::cout << "  " << std::left << std::setw(8) << "op" << std::right
+              << std::setw(10) << "count" << std::setw(10) << "mean_us"
+              << std::setw(10) << "p50_us" << std::setw(10) << "p95_us" << std::setw(10) << "p99_us"
+              << std::setw(10) << "p999_us" << std::setw(10) << "max_us" << "\n";
+    for (int op = 0; op < OP_COUNT; ++op) {
+        const Histogram& h = result.histograms[op];
+        if (h.count() == 0) continue;
+        std::cout << "  " << std::left << std::setw(8) << OP_NAMES[op] << std::right
+                  << std::setw(10) << h.count() << std::setprecision(1)
+                  << std::setw(10) << h.mean() / 1000.0
+                  << std::setw(10) << h.percentile(0.50) / 1000.0
+                  << std::setw(10) << h.percentile(0.95) / 1000.0
+                  << std::setw(10) << h.percentile(0.99) / 1000.0
+                  << std::setw(10) << h.percentile(0.999) / 1000.0
+                  << std::setw(10) << h.max() / 1000.0 << "\n";
+    }
+}
+
+void writeJson(std::ostream& os, const WorkloadConfig& config, const PhaseResult& result) {
+    os << std::fixed << std::setprecision(3);
+    for (int op = 0; op < OP_COUNT; ++op) {
+        const Histogram& h = result.histograms[op];
+        if (h.count() == 0) continue;
+        os << "{\"threads\":" << result.threads
+           << ",\"records\":" << config.records
+           << ",\"distribution\":\"" << (config.zipfian ? "zipfian" : "uniform") << "\""
+           << ",\"op\":\"" << OP_NAMES[op] << "\""
+           << ",\"count\":" << h.count()
+           << ",\"throughput_ops_s\":" << h.count() / result.seconds
+           << ",\"mean_us\":" << h.mean() / 1000.0
+           << ",\"p50_us\":" << h.percentile(0.50) / 1000.0
+           << ",\"p95_us\":" << h.percentile(0.95) / 1000.0
+           << ",\"p99_us\":" << h.percentile(0.99) / 1000.0
+           << ",\"p999_us\":" << h.percentile(0.999) / 1000.0
+           << ",\"max_us\":" << h.max() / 1000.0 << "}\n";
+    }
+}
+
+bool parseArgs(int argc, char** argv, WorkloadConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Missing value for " << arg << ".\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "--records") config.records = std::stoull(value);
+            else if (arg == "--threads") {
+                config.thread_counts.clear();
+                std::stringstream ss(value);
+                std::string count;
+                while (std::getline(ss, count, ',')) {
+                    config.thread_counts.push_back(std::stoull(count));
+                }
+            }
+            else if (arg == "--duration") config.duration = std::stod(value);
+            else if (arg == "--operations") config.operations = std::stoull(value);
+            else if (arg == "--read") config.read_proportion = std::stod(value);
+            else if (arg == "--update") config.update_proportion = std::stod(value);
+            else if (arg == "--insert") config.insert_proportion = std::stod(value);
+            else if (arg == "--distribution") {
+                if (value != "zipfian" && value != "uniform") {
+                    std::cerr << "Error: Distribution must be zipfian or uniform.\n";
+                    return false;
+                }
+                config.zipfian = value == "zipfian";
+            }
+            else if (arg == "--theta") config.theta = std::stod(value);
+            else if (arg == "--fields") config.fields = std::stoull(value);
+            else if (arg == "--field-length") config.field_length = std::stoull(value);
+            else if (arg == "--seed") config.seed = std::stoull(value);
+            else if (arg == "--json") config.json_path = value;
+            else {
+                std::cerr << "Error: Unknown option " << arg << ".\n";
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid value for " << arg << ".\n";
+            return false;
+        }
+    }
+    double total = config.read_proportion + config.update_proportion + config.insert_proportion;
+    if (std::abs(total - 1.0) > 1e-6) {
+        std::cerr << "Error: --read, --update and --insert must add up to 1.\n";
+        return false;
+    }
+    if (config.records < 2 || config.thread_counts.empty() || config.fields == 0 ||
+        config.theta <= 0.0 || config.theta >= 1.0) {
+        std::cerr << "Error: Need at least 2 records, 1 field, a thread count and 0 < theta < 1.\n";
+        return false;
+    }
+    for (size_t count : config.thread_counts) {
+        if (count == 0) {
+            std::cerr << "Error: Thread counts must be positive.\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    WorkloadConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        return 1;
+    }
+
+    // Tables always live in ./data, so run inside a scratch directory
+    fs::path json_path = fs::absolute(config.json_path);
+    fs::path work_dir = fs::temp_directory_path() / ("minidb_ycsb_" + std::to_string(std::random_device{}()));
+    fs::create_directories(work_dir / "data");
+    fs::path original_dir = fs::current_path();
+    fs::current_path(work_dir);
+
+    std::vector<std::string> columns = {"ycsb_key"};
+    for (size_t f = 0; f < config.fields; ++f) {
+        columns.push_back("field" + std::to_string(f));
+    }
+
+    Database db;
+    std::vector<PhaseResult> results;
+    {
+        // Load phase: ordered keys so zone maps can prune point reads, Bloom filter on the key
+        NullBuffer null_buffer;
+        std::ostream null_stream(&null_buffer);
+        QueryContext load_ctx(null_stream, null_stream);
+        std::streambuf* saved = std::cout.rdbuf(&null_buffer);
+        db.createTable("usertable", columns, {"ycsb_key"});
+        std::cout.rdbuf(saved);
+        Table* table = db.getTable("usertable");
+        std::mt19937_64 rng(config.seed);
+        for (uint64_t id = 0; id < config.records; ++id) {
+            std::vector<std::string> row = {makeKey(id)};
+            for (size_t f = 0; f < config.fields; ++f) {
+                row.push_back(randomValue(rng, config.field_length));
+            }
+            table->insert(row, &load_ctx);
+        }
+        table->save();
+        std::cout << "Loaded " << config.records << " records with " << config.fields << " fields.\n";
+
+        std::shared_mutex table_lock;
+        std::atomic<uint64_t> next_key{config.records};
+        double baseline = 0.0;
+        for (size_t thread_count : config.thread_counts) {
+            PhaseResult result = runPhase(config, table, table_lock, next_key, thread_count);
+            if (baseline == 0.0) baseline = result.throughput();
+            printPhase(result, baseline);
+            results.push_back(std::move(result));
+        }
+    }
+
+    fs::current_path(original_dir);
+    fs::remove_all(work_dir);
+
+    std::ofstream json(json_path, std::ios::app);
+    if (!json) {
+        std::cerr << "Error: Unable to open " << json_path << " for writing.\n";
+        return 1;
+    }
+    for (const auto& result : results) {
+        writeJson(json, config, result);
+    }
+    std::cout << "Results appended to " << json_path.string() << "\n";
+    return 0;
+}